@@ -0,0 +1,73 @@
+#include "bench.hpp"
+#include <circular_buffer_algorithm.hpp>
+
+#include <numeric>
+
+namespace {
+
+    const std::size_t ops = 1 << 24;
+    const std::size_t N   = 8192;
+
+    // a wrapped window as in per tick feature computations
+    template<class T>
+    jm::circular_buffer<T, N>& window()
+    {
+        static jm::circular_buffer<T, N> cb;
+        if(cb.empty())
+            for(std::size_t i = 0; i < N + N / 3; ++i)
+                cb.push_back(static_cast<T>(i % 97));
+        return cb;
+    }
+
+    // floating point sums stay sequential without -ffast-math, so integers show the
+    // difference vectorization makes
+    double accumulate_iterators()
+    {
+        auto& cb = window<int>();
+        return jm_bench::ns_per_op(ops, [&cb](std::size_t n) {
+            int sum = 0;
+            for(std::size_t i = 0; i < n; i += N)
+                sum = std::accumulate(cb.begin(), cb.end(), sum);
+            jm_bench::do_not_optimize(sum);
+        });
+    }
+
+    double accumulate_segmented()
+    {
+        auto& cb = window<int>();
+        return jm_bench::ns_per_op(ops, [&cb](std::size_t n) {
+            int sum = 0;
+            for(std::size_t i = 0; i < n; i += N)
+                sum = jm::accumulate(cb, sum);
+            jm_bench::do_not_optimize(sum);
+        });
+    }
+
+    double count_if_iterators()
+    {
+        auto& cb = window<float>();
+        return jm_bench::ns_per_op(ops, [&cb](std::size_t n) {
+            std::ptrdiff_t count = 0;
+            for(std::size_t i = 0; i < n; i += N)
+                count += std::count_if(cb.begin(), cb.end(), [](float v) { return v > 50.f; });
+            jm_bench::do_not_optimize(count);
+        });
+    }
+
+    double count_if_segmented()
+    {
+        auto& cb = window<float>();
+        return jm_bench::ns_per_op(ops, [&cb](std::size_t n) {
+            std::size_t count = 0;
+            for(std::size_t i = 0; i < n; i += N)
+                count += jm::count_if(cb, [](float v) { return v > 50.f; });
+            jm_bench::do_not_optimize(count);
+        });
+    }
+
+} // namespace
+
+JM_BENCH_REGISTER("algorithm/accumulate/iterators/8192", accumulate_iterators);
+JM_BENCH_REGISTER("algorithm/accumulate/segmented/8192", accumulate_segmented);
+JM_BENCH_REGISTER("algorithm/count_if/iterators/8192", count_if_iterators);
+JM_BENCH_REGISTER("algorithm/count_if/segmented/8192", count_if_segmented);
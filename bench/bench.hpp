@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// minimal self contained benchmark harness, benchmarks register themselves
+// with JM_BENCH_REGISTER and bench/main.cpp runs all of them
+
+#ifndef JM_CIRCULAR_BUFFER_BENCH_HPP
+#define JM_CIRCULAR_BUFFER_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace jm_bench {
+
+    template<class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    /// runs fn(ops) a few times and returns the best time in nanoseconds per operation
+    template<class F>
+    double ns_per_op(std::size_t ops, F fn, int repetitions = 5)
+    {
+        double best = 0;
+        for(int i = 0; i < repetitions; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            fn(ops);
+            const std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+            const double per_op = elapsed.count() / static_cast<double>(ops);
+            if(i == 0 || per_op < best)
+                best = per_op;
+        }
+
+        return best;
+    }
+
+    typedef double (*benchmark_fn)();
+
+    struct benchmark {
+        std::string  name;
+        benchmark_fn fn;
+    };
+
+    inline std::vector<benchmark>& registry()
+    {
+        static std::vector<benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct registrar {
+        registrar(const char* name, benchmark_fn fn)
+        {
+            benchmark b = { name, fn };
+            registry().push_back(b);
+        }
+    };
+
+} // namespace jm_bench
+
+#define JM_BENCH_CONCAT_IMPL(a, b) a##b
+#define JM_BENCH_CONCAT(a, b) JM_BENCH_CONCAT_IMPL(a, b)
+
+#define JM_BENCH_REGISTER(name, ...)                                               \
+    static ::jm_bench::registrar JM_BENCH_CONCAT(jm_bench_registrar_, __LINE__)( \
+        name, &__VA_ARGS__)
+
+#endif // include guard
@@ -0,0 +1,81 @@
+#include "bench.hpp"
+#include <blocking_circular_buffer.hpp>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const std::size_t items    = 1 << 18;
+    const std::size_t capacity = 256;
+
+    struct condition_variable_queue {
+        std::mutex                                              lock;
+        std::condition_variable                                 not_full;
+        std::condition_variable                                 not_empty;
+        jm::circular_buffer<unsigned, capacity, jm::mask_index> cb;
+
+        void push(unsigned v)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            not_full.wait(guard, [this] { return !cb.full(); });
+            cb.push_back(v);
+            guard.unlock();
+            not_empty.notify_one();
+        }
+
+        void pop(unsigned& v)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            not_empty.wait(guard, [this] { return !cb.empty(); });
+            v = cb.front();
+            cb.pop_front();
+            guard.unlock();
+            not_full.notify_one();
+        }
+    };
+
+    // Threads / 2 producers hand items elements to Threads / 2 consumers with
+    // blocking push and pop, reported as ns per element
+    template<class Queue, unsigned Threads>
+    double handoff()
+    {
+        return jm_bench::ns_per_op(items, [](std::size_t n) {
+            std::unique_ptr<Queue>   q(new Queue());
+            const unsigned           pairs = Threads / 2;
+            std::vector<std::thread> threads;
+
+            for(unsigned p = 0; p < pairs; ++p)
+                threads.emplace_back([&, p] {
+                    const std::size_t count = n / pairs + (p < n % pairs ? 1 : 0);
+                    for(unsigned i = 0; i < count; ++i)
+                        q->push(i);
+                });
+
+            for(unsigned c = 0; c < pairs; ++c)
+                threads.emplace_back([&, c] {
+                    const std::size_t count = n / pairs + (c < n % pairs ? 1 : 0);
+                    unsigned          v     = 0;
+                    for(unsigned i = 0; i < count; ++i)
+                        q->pop(v);
+                    jm_bench::do_not_optimize(v);
+                });
+
+            for(auto& t : threads)
+                t.join();
+        }, 3);
+    }
+
+    typedef jm::blocking_circular_buffer<unsigned, capacity> blocking;
+
+} // namespace
+
+JM_BENCH_REGISTER("blocking/threads_2/condition_variable", handoff<condition_variable_queue, 2>);
+JM_BENCH_REGISTER("blocking/threads_2/blocking_circular_buffer", handoff<blocking, 2>);
+JM_BENCH_REGISTER("blocking/threads_4/condition_variable", handoff<condition_variable_queue, 4>);
+JM_BENCH_REGISTER("blocking/threads_4/blocking_circular_buffer", handoff<blocking, 4>);
+JM_BENCH_REGISTER("blocking/threads_8/condition_variable", handoff<condition_variable_queue, 8>);
+JM_BENCH_REGISTER("blocking/threads_8/blocking_circular_buffer", handoff<blocking, 8>);
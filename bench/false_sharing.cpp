@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include <circular_buffer.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const std::size_t ops     = 1 << 22;
+    const std::size_t threads = 4;
+
+    // every thread pushes and pops on its own small ring, the rings are neighbours in
+    // one array. Packed rings share cache lines, so the cores keep stealing the lines
+    // from each other even though no data is shared.
+    template<class Layout>
+    double private_rings()
+    {
+        typedef jm::circular_buffer<unsigned, 8, jm::mask_index, jm::no_stats, Layout> ring;
+
+        return jm_bench::ns_per_op(ops, [](std::size_t n) {
+            ring rings[threads];
+
+            std::vector<std::thread> workers;
+            for(std::size_t t = 0; t < threads; ++t)
+                workers.emplace_back([&rings, t, n] {
+                    ring&    cb  = rings[t];
+                    unsigned sum = 0;
+                    for(unsigned i = 0; i < n; ++i) {
+                        cb.push_back(i);
+                        if(cb.full()) {
+                            sum += cb.front();
+                            cb.pop_front();
+                        }
+                    }
+                    jm_bench::do_not_optimize(sum);
+                });
+
+            for(auto& worker : workers)
+                worker.join();
+        }, 3);
+    }
+
+} // namespace
+
+JM_BENCH_REGISTER("false_sharing/4_threads/packed_layout",
+                  private_rings<jm::packed_layout>);
+JM_BENCH_REGISTER("false_sharing/4_threads/cache_aligned_layout",
+                  private_rings<jm::cache_aligned_layout>);
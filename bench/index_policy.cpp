@@ -0,0 +1,74 @@
+#include "bench.hpp"
+#include <circular_buffer.hpp>
+
+namespace {
+
+    const std::size_t ops = 1 << 22;
+
+    // steady state full buffer, every push overwrites the oldest element
+    template<class Index, std::size_t N>
+    double push_back_full()
+    {
+        return jm_bench::ns_per_op(ops, [](std::size_t n) {
+            jm::circular_buffer<int, N, Index> cb;
+            for(std::size_t i = 0; i < n; ++i)
+                cb.push_back(static_cast<int>(i));
+            jm_bench::do_not_optimize(cb);
+        });
+    }
+
+    // queue usage where every push is followed by a pop
+    template<class Index, std::size_t N>
+    double push_pop()
+    {
+        return jm_bench::ns_per_op(ops, [](std::size_t n) {
+            jm::circular_buffer<int, N, Index> cb(N / 2, 0);
+            for(std::size_t i = 0; i < n; ++i) {
+                cb.push_back(static_cast<int>(i));
+                jm_bench::do_not_optimize(cb.front());
+                cb.pop_front();
+            }
+        });
+    }
+
+    template<class Index, std::size_t N>
+    double iterate()
+    {
+        jm::circular_buffer<int, N, Index> cb;
+        for(std::size_t i = 0; i < N + N / 2; ++i)
+            cb.push_back(static_cast<int>(i));
+
+        return jm_bench::ns_per_op(ops, [&cb](std::size_t n) {
+            int sum = 0;
+            for(std::size_t i = 0; i < n; i += N)
+                for(int v : cb)
+                    sum += v;
+            jm_bench::do_not_optimize(sum);
+        });
+    }
+
+} // namespace
+
+JM_BENCH_REGISTER("index/push_back_full/modulo/1024", push_back_full<jm::modulo_index, 1024>);
+JM_BENCH_REGISTER("index/push_back_full/mask/1024", push_back_full<jm::mask_index, 1024>);
+JM_BENCH_REGISTER("index/push_back_full/branchless/1024",
+                  push_back_full<jm::branchless_index, 1024>);
+JM_BENCH_REGISTER("index/push_back_full/counter/1024",
+                  push_back_full<jm::counter_index, 1024>);
+JM_BENCH_REGISTER("index/push_back_full/modulo/1000", push_back_full<jm::modulo_index, 1000>);
+JM_BENCH_REGISTER("index/push_back_full/branchless/1000",
+                  push_back_full<jm::branchless_index, 1000>);
+
+JM_BENCH_REGISTER("index/push_pop/modulo/1024", push_pop<jm::modulo_index, 1024>);
+JM_BENCH_REGISTER("index/push_pop/mask/1024", push_pop<jm::mask_index, 1024>);
+JM_BENCH_REGISTER("index/push_pop/branchless/1024", push_pop<jm::branchless_index, 1024>);
+JM_BENCH_REGISTER("index/push_pop/counter/1024", push_pop<jm::counter_index, 1024>);
+JM_BENCH_REGISTER("index/push_pop/modulo/1000", push_pop<jm::modulo_index, 1000>);
+JM_BENCH_REGISTER("index/push_pop/branchless/1000", push_pop<jm::branchless_index, 1000>);
+
+JM_BENCH_REGISTER("index/iterate/modulo/1024", iterate<jm::modulo_index, 1024>);
+JM_BENCH_REGISTER("index/iterate/mask/1024", iterate<jm::mask_index, 1024>);
+JM_BENCH_REGISTER("index/iterate/branchless/1024", iterate<jm::branchless_index, 1024>);
+JM_BENCH_REGISTER("index/iterate/counter/1024", iterate<jm::counter_index, 1024>);
+JM_BENCH_REGISTER("index/iterate/modulo/1000", iterate<jm::modulo_index, 1000>);
+JM_BENCH_REGISTER("index/iterate/branchless/1000", iterate<jm::branchless_index, 1000>);
@@ -0,0 +1,83 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    void print_json_string(const char* str)
+    {
+        std::putchar('"');
+        for(; *str; ++str) {
+            if(*str == '"' || *str == '\\')
+                std::putchar('\\');
+            std::putchar(*str);
+        }
+        std::putchar('"');
+    }
+
+    // the build settings that change the results, so that runs can be told apart
+    void print_json_config()
+    {
+        std::printf("  \"config\": {\n    \"compiler\": ");
+#if defined(__VERSION__)
+        print_json_string(__VERSION__);
+#else
+        print_json_string("unknown");
+#endif
+        std::printf(",\n    \"cplusplus\": %ld,\n", static_cast<long>(__cplusplus));
+#if defined(JM_CIRCULAR_BUFFER_LIKELY_FULL)
+        std::printf("    \"fullness_hint\": \"likely_full\",\n");
+#elif defined(JM_CIRCULAR_BUFFER_UNLIKELY_FULL)
+        std::printf("    \"fullness_hint\": \"unlikely_full\",\n");
+#else
+        std::printf("    \"fullness_hint\": null,\n");
+#endif
+#if defined(NDEBUG)
+        std::printf("    \"ndebug\": true\n  },\n");
+#else
+        std::printf("    \"ndebug\": false\n  },\n");
+#endif
+    }
+
+} // namespace
+
+// usage: circular_buffer_bench [--json] [name filter]
+int main(int argc, char** argv)
+{
+    bool        json   = false;
+    const char* filter = "";
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "--json") == 0)
+            json = true;
+        else
+            filter = argv[i];
+    }
+
+    if(json) {
+        std::printf("{\n");
+        print_json_config();
+        std::printf("  \"benchmarks\": [");
+    }
+
+    bool first = true;
+    for(const auto& b : jm_bench::registry()) {
+        if(b.name.find(filter) == std::string::npos)
+            continue;
+
+        const double ns = b.fn();
+        if(json) {
+            std::printf(first ? "\n    { \"name\": " : ",\n    { \"name\": ");
+            print_json_string(b.name.c_str());
+            std::printf(", \"ns_per_op\": %.4f }", ns);
+            std::fflush(stdout);
+        }
+        else
+            std::printf("%-56s %10.3f ns/op\n", b.name.c_str(), ns);
+
+        first = false;
+    }
+
+    if(json)
+        std::printf("\n  ]\n}\n");
+}
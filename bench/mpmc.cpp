@@ -0,0 +1,104 @@
+#include "bench.hpp"
+#include <mpmc_circular_buffer.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const std::size_t items    = 1 << 20;
+    const std::size_t capacity = 1024;
+
+    struct locked_queue {
+        std::mutex                                              lock;
+        jm::circular_buffer<unsigned, capacity, jm::mask_index> cb;
+
+        bool try_push(unsigned v)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(cb.full())
+                return false;
+            cb.push_back(v);
+            return true;
+        }
+
+        bool try_pop(unsigned& v)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(cb.empty())
+                return false;
+            v = cb.front();
+            cb.pop_front();
+            return true;
+        }
+    };
+
+    // Threads / 2 producers and Threads / 2 consumers (one thread doing both for 1)
+    // move items elements through the queue, reported as ns per element
+    template<class Queue, unsigned Threads>
+    double scaling()
+    {
+        return jm_bench::ns_per_op(items, [](std::size_t n) {
+            std::unique_ptr<Queue> q(new Queue());
+
+            if(Threads == 1) {
+                unsigned v = 0;
+                for(unsigned i = 0; i < n; ++i) {
+                    q->try_push(i);
+                    q->try_pop(v);
+                }
+                jm_bench::do_not_optimize(v);
+                return;
+            }
+
+            const unsigned           pairs = Threads / 2;
+            std::atomic<std::size_t> consumed(0);
+            std::vector<std::thread> threads;
+
+            for(unsigned p = 0; p < pairs; ++p)
+                threads.emplace_back([&, p] {
+                    const std::size_t count = n / pairs + (p < n % pairs ? 1 : 0);
+                    for(unsigned i = 0; i < count;) {
+                        if(q->try_push(i))
+                            ++i;
+                        else
+                            std::this_thread::yield();
+                    }
+                });
+
+            for(unsigned c = 0; c < pairs; ++c)
+                threads.emplace_back([&] {
+                    unsigned v = 0;
+                    while(consumed.load(std::memory_order_relaxed) < n) {
+                        if(q->try_pop(v))
+                            consumed.fetch_add(1, std::memory_order_relaxed);
+                        else
+                            std::this_thread::yield();
+                    }
+                    jm_bench::do_not_optimize(v);
+                });
+
+            for(auto& t : threads)
+                t.join();
+        }, 3);
+    }
+
+    typedef jm::mpmc_circular_buffer<unsigned, capacity> mpmc;
+
+} // namespace
+
+JM_BENCH_REGISTER("mpmc/threads_1/mutex_circular_buffer", scaling<locked_queue, 1>);
+JM_BENCH_REGISTER("mpmc/threads_1/mpmc_circular_buffer", scaling<mpmc, 1>);
+JM_BENCH_REGISTER("mpmc/threads_2/mutex_circular_buffer", scaling<locked_queue, 2>);
+JM_BENCH_REGISTER("mpmc/threads_2/mpmc_circular_buffer", scaling<mpmc, 2>);
+JM_BENCH_REGISTER("mpmc/threads_4/mutex_circular_buffer", scaling<locked_queue, 4>);
+JM_BENCH_REGISTER("mpmc/threads_4/mpmc_circular_buffer", scaling<mpmc, 4>);
+JM_BENCH_REGISTER("mpmc/threads_8/mutex_circular_buffer", scaling<locked_queue, 8>);
+JM_BENCH_REGISTER("mpmc/threads_8/mpmc_circular_buffer", scaling<mpmc, 8>);
+JM_BENCH_REGISTER("mpmc/threads_16/mutex_circular_buffer", scaling<locked_queue, 16>);
+JM_BENCH_REGISTER("mpmc/threads_16/mpmc_circular_buffer", scaling<mpmc, 16>);
+JM_BENCH_REGISTER("mpmc/threads_32/mutex_circular_buffer", scaling<locked_queue, 32>);
+JM_BENCH_REGISTER("mpmc/threads_32/mpmc_circular_buffer", scaling<mpmc, 32>);
@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include <spsc_circular_buffer.hpp>
+
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+    const std::size_t items    = 1 << 20;
+    const std::size_t capacity = 1024;
+
+    // mutex around the plain circular_buffer, the baseline handoff
+    struct locked_queue {
+        std::mutex                                lock;
+        jm::circular_buffer<unsigned, capacity, jm::mask_index> cb;
+
+        bool try_push(unsigned v)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(cb.full())
+                return false;
+            cb.push_back(v);
+            return true;
+        }
+
+        bool try_pop(unsigned& v)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(cb.empty())
+                return false;
+            v = cb.front();
+            cb.pop_front();
+            return true;
+        }
+    };
+
+    template<class Queue>
+    double single()
+    {
+        return jm_bench::ns_per_op(items, [](std::size_t n) {
+            std::unique_ptr<Queue> q(new Queue());
+
+            std::thread producer([&] {
+                for(unsigned i = 0; i < n;)
+                    i += q->try_push(i);
+            });
+
+            unsigned v = 0, sum = 0;
+            for(std::size_t i = 0; i < n;)
+                if(q->try_pop(v)) {
+                    sum += v;
+                    ++i;
+                }
+
+            producer.join();
+            jm_bench::do_not_optimize(sum);
+        }, 3);
+    }
+
+    template<std::size_t Batch>
+    double batched()
+    {
+        typedef jm::spsc_circular_buffer<unsigned, capacity> queue;
+        return jm_bench::ns_per_op(items, [](std::size_t n) {
+            std::unique_ptr<queue> q(new queue());
+
+            std::thread producer([&] {
+                unsigned batch[Batch];
+                for(unsigned i = 0; i < n;) {
+                    for(unsigned j = 0; j < Batch; ++j)
+                        batch[j] = i + j;
+                    i += static_cast<unsigned>(q->try_push(batch, batch + Batch));
+                }
+            });
+
+            unsigned out[Batch], sum = 0;
+            for(std::size_t i = 0; i < n;) {
+                const std::size_t got = q->try_pop(out, Batch);
+                for(std::size_t j = 0; j < got; ++j)
+                    sum += out[j];
+                i += got;
+            }
+
+            producer.join();
+            jm_bench::do_not_optimize(sum);
+        }, 3);
+    }
+
+} // namespace
+
+JM_BENCH_REGISTER("spsc/handoff/mutex_circular_buffer", single<locked_queue>);
+JM_BENCH_REGISTER("spsc/handoff/spsc_circular_buffer",
+                  single<jm::spsc_circular_buffer<unsigned, capacity>>);
+JM_BENCH_REGISTER("spsc/handoff_batch_64/spsc_circular_buffer", batched<64>);
@@ -0,0 +1,208 @@
+#include "bench.hpp"
+#include <circular_buffer.hpp>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+// circular_buffer against std::deque and a hand rolled ring over a grid of operations,
+// element types and capacities. Every ring is wrapped in the same small interface so
+// that all of them run the exact same benchmark code.
+namespace {
+
+    const std::size_t ops = 1 << 22;
+
+    struct blob64 {
+        char data[64];
+
+        blob64() {}
+        blob64(std::size_t v) { data[0] = static_cast<char>(v); }
+        operator int() const { return data[0]; }
+    };
+
+    template<class T, std::size_t N>
+    struct jm_ring {
+        jm::circular_buffer<T, N> c;
+
+        void push(const T& v) { c.push_back(v); }
+        void pop() { c.pop_front(); }
+        const T& front() const { return c.front(); }
+
+        template<class F>
+        void for_each(F& f) const
+        {
+            for(const T& v : c)
+                f(v);
+        }
+    };
+
+    // what a ring written in place usually looks like
+    template<class T, std::size_t N>
+    struct naive_ring {
+        T           data[N];
+        std::size_t head = 0;
+        std::size_t size = 0;
+
+        void push(const T& v)
+        {
+            data[(head + size) % N] = v;
+            if(size == N)
+                head = (head + 1) % N;
+            else
+                ++size;
+        }
+
+        void pop()
+        {
+            head = (head + 1) % N;
+            --size;
+        }
+
+        const T& front() const { return data[head]; }
+
+        template<class F>
+        void for_each(F& f) const
+        {
+            for(std::size_t i = 0; i < size; ++i)
+                f(data[(head + i) % N]);
+        }
+    };
+
+    template<class T, std::size_t N>
+    struct deque_ring {
+        std::deque<T> c;
+
+        void push(const T& v)
+        {
+            if(c.size() == N)
+                c.pop_front();
+            c.push_back(v);
+        }
+
+        void pop() { c.pop_front(); }
+        const T& front() const { return c.front(); }
+
+        template<class F>
+        void for_each(F& f) const
+        {
+            for(const T& v : c)
+                f(v);
+        }
+    };
+
+    template<class Ring, class T, std::size_t N>
+    std::unique_ptr<Ring> make_full()
+    {
+        std::unique_ptr<Ring> ring(new Ring());
+        for(std::size_t i = 0; i < N; ++i)
+            ring->push(T(i));
+        return ring;
+    }
+
+    // steady state full buffer, every push evicts the oldest element
+    template<class Ring, class T, std::size_t N>
+    double push_full()
+    {
+        return jm_bench::ns_per_op(ops, [](std::size_t n) {
+            auto ring = make_full<Ring, T, N>();
+            for(std::size_t i = 0; i < n; ++i)
+                ring->push(T(i));
+            jm_bench::do_not_optimize(ring->front());
+        });
+    }
+
+    // mostly empty queue, every push is consumed right away
+    template<class Ring, class T, std::size_t N>
+    double push_pop_empty()
+    {
+        return jm_bench::ns_per_op(ops, [](std::size_t n) {
+            std::unique_ptr<Ring> ring(new Ring());
+            for(std::size_t i = 0; i < n; ++i) {
+                ring->push(T(i));
+                jm_bench::do_not_optimize(ring->front());
+                ring->pop();
+            }
+        });
+    }
+
+    // per element
+    template<class Ring, class T, std::size_t N>
+    double iterate()
+    {
+        auto ring = make_full<Ring, T, N>();
+        return jm_bench::ns_per_op(ops, [&ring](std::size_t n) {
+            int  sum = 0;
+            auto add = [&sum](const T& v) { sum += static_cast<int>(v); };
+            for(std::size_t i = 0; i < n; i += N)
+                ring->for_each(add);
+            jm_bench::do_not_optimize(sum);
+        });
+    }
+
+    // per element, copy construction of a full buffer including its allocation
+    template<class Ring, class T, std::size_t N>
+    double copy()
+    {
+        auto ring = make_full<Ring, T, N>();
+        return jm_bench::ns_per_op(ops, [&ring](std::size_t n) {
+            for(std::size_t i = 0; i < n; i += N) {
+                std::unique_ptr<Ring> copy(new Ring(*ring));
+                jm_bench::do_not_optimize(copy->front());
+            }
+        });
+    }
+
+    // per move assignment of a full buffer
+    template<class Ring, class T, std::size_t N>
+    double move()
+    {
+        auto a = make_full<Ring, T, N>();
+        auto b = make_full<Ring, T, N>();
+        return jm_bench::ns_per_op(ops / 64, [&a, &b](std::size_t n) {
+            for(std::size_t i = 0; i < n; i += 2) {
+                *b = std::move(*a);
+                *a = std::move(*b);
+            }
+            jm_bench::do_not_optimize(a->front());
+        });
+    }
+
+    template<template<class, std::size_t> class Ring, class T, std::size_t N>
+    void add_ring(const char* ring, const char* type)
+    {
+        typedef Ring<T, N> ring_type;
+
+        const std::string suffix =
+            std::string("/") + ring + "/" + type + "/" + std::to_string(N);
+
+        auto& registry = jm_bench::registry();
+        registry.push_back({ "suite/push_full" + suffix, &push_full<ring_type, T, N> });
+        registry.push_back(
+            { "suite/push_pop_empty" + suffix, &push_pop_empty<ring_type, T, N> });
+        registry.push_back({ "suite/iterate" + suffix, &iterate<ring_type, T, N> });
+        registry.push_back({ "suite/copy" + suffix, &copy<ring_type, T, N> });
+        registry.push_back({ "suite/move" + suffix, &move<ring_type, T, N> });
+    }
+
+    template<class T, std::size_t N>
+    void add_size(const char* type)
+    {
+        add_ring<jm_ring, T, N>("circular_buffer", type);
+        add_ring<naive_ring, T, N>("naive_ring", type);
+        add_ring<deque_ring, T, N>("deque", type);
+    }
+
+    bool add_suite()
+    {
+        add_size<int, 16>("int");
+        add_size<int, 1024>("int");
+        add_size<int, 65536>("int");
+        add_size<blob64, 16>("blob64");
+        add_size<blob64, 1024>("blob64");
+        add_size<blob64, 65536>("blob64");
+        return true;
+    }
+
+    const bool suite_added = add_suite();
+
+} // namespace
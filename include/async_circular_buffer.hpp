@@ -0,0 +1,308 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_ASYNC_CIRCULAR_BUFFER_HPP
+#define JM_ASYNC_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+
+namespace jm {
+
+    namespace detail {
+
+        // FIFO of suspended awaiters linked through their _next member
+        template<class Awaiter>
+        struct cb_waiter_list {
+            Awaiter* head = nullptr;
+            Awaiter* tail = nullptr;
+
+            void push(Awaiter* waiter) noexcept
+            {
+                waiter->_next = nullptr;
+                if(tail)
+                    tail->_next = waiter;
+                else
+                    head = waiter;
+                tail = waiter;
+            }
+
+            Awaiter* pop() noexcept
+            {
+                Awaiter* waiter = head;
+                head            = waiter->_next;
+                if(!head)
+                    tail = nullptr;
+                return waiter;
+            }
+        };
+
+    } // namespace detail
+
+    /// bounded queue for coroutines running on a single thread, backed by a
+    /// circular_buffer. co_await push(v) suspends while the queue is full and
+    /// co_await pop() while it is empty. Suspended coroutines wait in intrusive lists
+    /// of their awaiters, which live in the coroutine frames, and the operation that
+    /// unblocks one resumes it inline: a push hands its value straight to the oldest
+    /// waiting consumer, a pop refills the freed slot from the oldest waiting producer.
+    /// The queue must outlive the coroutines suspended on it.
+    template<typename T, std::size_t N>
+    class async_circular_buffer {
+    public:
+        typedef T           value_type;
+        typedef std::size_t size_type;
+
+        class push_awaiter;
+        class pop_awaiter;
+
+    private:
+        circular_buffer<T, N>                _buffer;
+        detail::cb_waiter_list<push_awaiter> _producers;
+        detail::cb_waiter_list<pop_awaiter>  _consumers;
+
+        // stores value or hands it to a waiting consumer, value is left untouched
+        // when the queue is full
+        template<class U>
+        bool push_value(U&& value)
+        {
+            if(_consumers.head) {
+                pop_awaiter* consumer = _consumers.pop();
+                consumer->_value.emplace(std::forward<U>(value));
+                consumer->_handle.resume();
+                return true;
+            }
+
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_buffer.full()))
+                return false;
+
+            _buffer.push_back(std::forward<U>(value));
+            return true;
+        }
+
+        bool pop_value(std::optional<T>& out)
+        {
+            if(_buffer.empty())
+                return false;
+
+            out.emplace(std::move(_buffer.front()));
+            _buffer.pop_front();
+
+            if(_producers.head) {
+                push_awaiter* producer = _producers.pop();
+                _buffer.push_back(std::move(producer->_value));
+                producer->_handle.resume();
+            }
+
+            return true;
+        }
+
+    public:
+        class [[nodiscard]] push_awaiter {
+            friend class async_circular_buffer;
+            friend struct detail::cb_waiter_list<push_awaiter>;
+
+            async_circular_buffer&  _queue;
+            T                       _value;
+            std::coroutine_handle<> _handle;
+            push_awaiter*           _next = nullptr;
+
+            template<class U>
+            push_awaiter(async_circular_buffer& queue, U&& value)
+                : _queue(queue), _value(std::forward<U>(value))
+            {}
+
+        public:
+            bool await_ready() { return _queue.push_value(std::move(_value)); }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                _handle = handle;
+                _queue._producers.push(this);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        class [[nodiscard]] pop_awaiter {
+            friend class async_circular_buffer;
+            friend struct detail::cb_waiter_list<pop_awaiter>;
+
+            async_circular_buffer&  _queue;
+            std::optional<T>        _value;
+            std::coroutine_handle<> _handle;
+            pop_awaiter*            _next = nullptr;
+
+            explicit pop_awaiter(async_circular_buffer& queue) : _queue(queue) {}
+
+        public:
+            bool await_ready() { return _queue.pop_value(_value); }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                _handle = handle;
+                _queue._consumers.push(this);
+            }
+
+            T await_resume() { return std::move(*_value); }
+        };
+
+        async_circular_buffer() = default;
+
+        async_circular_buffer(const async_circular_buffer&) = delete;
+        async_circular_buffer& operator=(const async_circular_buffer&) = delete;
+
+        /// capacity
+        bool empty() const noexcept { return _buffer.empty(); }
+
+        bool full() const noexcept { return _buffer.full(); }
+
+        size_type size() const noexcept { return _buffer.size(); }
+
+        constexpr size_type max_size() const noexcept { return N; }
+
+        /// suspending operations
+        push_awaiter push(const value_type& value) { return push_awaiter(*this, value); }
+
+        push_awaiter push(value_type&& value) { return push_awaiter(*this, std::move(value)); }
+
+        pop_awaiter pop() { return pop_awaiter(*this); }
+
+        /// non suspending operations, they wake waiters the same way
+        bool try_push(const value_type& value) { return push_value(value); }
+
+        bool try_push(value_type&& value) { return push_value(std::move(value)); }
+
+        bool try_pop(value_type& out)
+        {
+            std::optional<T> value;
+            if(!pop_value(value))
+                return false;
+
+            out = std::move(*value);
+            return true;
+        }
+    };
+
+    /// fire and forget coroutine type to start on a single_thread_executor. It is
+    /// created suspended and destroys itself when it finishes.
+    class async_task {
+    public:
+        struct promise_type {
+            async_task get_return_object() noexcept
+            {
+                return async_task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            std::suspend_never final_suspend() const noexcept { return {}; }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+
+        async_task(async_task&& other) noexcept : _handle(other._handle)
+        {
+            other._handle = nullptr;
+        }
+
+        async_task(const async_task&) = delete;
+        async_task& operator=(const async_task&) = delete;
+
+        ~async_task()
+        {
+            if(_handle)
+                _handle.destroy();
+        }
+
+        /// gives up ownership of the not yet started coroutine
+        std::coroutine_handle<> release() noexcept
+        {
+            std::coroutine_handle<> handle = _handle;
+            _handle                        = nullptr;
+            return handle;
+        }
+
+    private:
+        std::coroutine_handle<> _handle;
+
+        explicit async_task(std::coroutine_handle<> handle) noexcept : _handle(handle) {}
+    };
+
+    /// minimal executor running coroutines one after another on the calling thread
+    class single_thread_executor {
+        std::deque<std::coroutine_handle<>> _ready;
+
+    public:
+        struct schedule_awaiter {
+            single_thread_executor& _executor;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                _executor._ready.push_back(handle);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        single_thread_executor() = default;
+
+        single_thread_executor(const single_thread_executor&) = delete;
+        single_thread_executor& operator=(const single_thread_executor&) = delete;
+
+        /// destroys the coroutines that never got to run
+        ~single_thread_executor()
+        {
+            for(std::coroutine_handle<> handle : _ready)
+                handle.destroy();
+        }
+
+        /// queues task to be started by run()
+        void spawn(async_task task) { _ready.push_back(task.release()); }
+
+        /// co_await executor.schedule() moves the coroutine to the back of the run queue
+        schedule_awaiter schedule() noexcept { return schedule_awaiter{ *this }; }
+
+        /// resumes queued coroutines until none are left and returns how many ran.
+        /// Coroutines still suspended on a queue are not counted as ready.
+        std::size_t run()
+        {
+            std::size_t resumed = 0;
+            while(!_ready.empty()) {
+                std::coroutine_handle<> handle = _ready.front();
+                _ready.pop_front();
+                handle.resume();
+                ++resumed;
+            }
+
+            return resumed;
+        }
+    };
+
+} // namespace jm
+
+#endif // __cpp_impl_coroutine
+
+#endif // include guard
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_BLOCKING_CIRCULAR_BUFFER_HPP
+#define JM_BLOCKING_CIRCULAR_BUFFER_HPP
+
+#include "mpmc_circular_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/// how many times blocking operations retry before going to sleep
+#ifndef JM_CB_SPIN_COUNT
+#define JM_CB_SPIN_COUNT 64
+#endif
+
+namespace jm {
+
+    namespace detail {
+
+        inline void cb_cpu_relax() noexcept
+        {
+#if defined(__i386__) || defined(__x86_64__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+        // a 32 bit counter threads can sleep on until it changes. On Linux it is a
+        // futex, elsewhere std::atomic::wait with polling for the timed wait.
+        class cb_wait_word {
+            std::atomic<std::uint32_t> _value;
+
+#if defined(__linux__)
+            JM_CB_STATIC_ASSERT(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                                "the futex word must be a plain 32 bit integer");
+
+            long futex(int op, std::uint32_t value, const timespec* timeout) noexcept
+            {
+                return ::syscall(SYS_futex,
+                                 reinterpret_cast<std::uint32_t*>(&_value),
+                                 op,
+                                 value,
+                                 timeout,
+                                 JM_CB_NULLPTR,
+                                 0);
+            }
+#endif
+
+        public:
+            cb_wait_word() noexcept : _value(0) {}
+
+            std::uint32_t load() const noexcept { return _value.load(std::memory_order_acquire); }
+
+            void bump_and_wake_one() noexcept
+            {
+                _value.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+                futex(FUTEX_WAKE_PRIVATE, 1, JM_CB_NULLPTR);
+#elif defined(__cpp_lib_atomic_wait)
+                _value.notify_one();
+#endif
+            }
+
+            /// sleeps while the counter equals expected, may return spuriously
+            void wait(std::uint32_t expected) noexcept
+            {
+#if defined(__linux__)
+                futex(FUTEX_WAIT_PRIVATE, expected, JM_CB_NULLPTR);
+#elif defined(__cpp_lib_atomic_wait)
+                _value.wait(expected, std::memory_order_acquire);
+#else
+                if(load() == expected)
+                    std::this_thread::yield();
+#endif
+            }
+
+            /// like wait, giving up after timeout
+            void wait_for(std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept
+            {
+#if defined(__linux__)
+                timespec ts;
+                ts.tv_sec  = static_cast<time_t>(timeout.count() / 1000000000);
+                ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+                futex(FUTEX_WAIT_PRIVATE, expected, &ts);
+#else
+                if(load() == expected)
+                    std::this_thread::sleep_for(
+                        (std::min)(timeout, std::chrono::nanoseconds(std::chrono::microseconds(50))));
+#endif
+            }
+        };
+
+    } // namespace detail
+
+    /// bounded queue for any number of producer and consumer threads where push blocks
+    /// while the queue is full and pop while it is empty. It is an mpmc_circular_buffer
+    /// with a sleeping slow path: after JM_CB_SPIN_COUNT failed attempts a thread
+    /// registers as a sleeper and waits on the counter of the opposite operation.
+    /// A push or pop only issues a wake up when a sleeper is registered, so no system
+    /// call is made while nobody waits. A woken thread passes the wake up on when there
+    /// is still work for the other sleepers.
+    template<typename T, std::size_t N>
+    class blocking_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        // consumers sleep on _pushes, producers on _pops
+        struct side {
+            alignas(JM_CB_CACHE_LINE_SIZE) detail::cb_wait_word counter;
+            std::atomic<std::uint32_t> sleepers;
+
+            side() noexcept : sleepers(0) {}
+
+            // every notify that sees a sleeper wakes one, even when an earlier wake up
+            // has not been taken yet. A flag to skip those can be left set by a sleeper
+            // leaving between the check and the wake, after which nobody is woken again.
+            void notify() noexcept
+            {
+                // pairs with the fence in blocking(), either the sleeper sees the element
+                // or this sees the sleeper
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(JM_CB_LIKELY(sleepers.load(std::memory_order_relaxed) == 0))
+                    return;
+
+                counter.bump_and_wake_one();
+            }
+        };
+
+        mpmc_circular_buffer<T, N> _queue;
+        side                       _pushes;
+        side                       _pops;
+
+        // retries op, sleeping on the opposite side until it succeeds or the deadline
+        // passes. The deadline is ignored when timed is false.
+        template<class Op>
+        static bool blocking(Op op, side& wait_on, bool timed, clock::time_point deadline)
+        {
+            for(int i = 0; i < JM_CB_SPIN_COUNT; ++i) {
+                if(op())
+                    return true;
+                detail::cb_cpu_relax();
+            }
+
+            for(;;) {
+                const std::uint32_t seen = wait_on.counter.load();
+                wait_on.sleepers.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                bool done = op();
+                if(!done) {
+                    if(!timed)
+                        wait_on.counter.wait(seen);
+                    else {
+                        const clock::time_point now = clock::now();
+                        if(now < deadline)
+                            wait_on.counter.wait_for(
+                                seen,
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+                    }
+                }
+
+                // the wake up may have been meant for another sleeper as well, pass it
+                // on if there is work left for them
+                wait_on.sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+                done = done || op();
+                if(op.more())
+                    wait_on.notify();
+                if(done)
+                    return true;
+                if(timed && clock::now() >= deadline)
+                    return false;
+            }
+        }
+
+        template<class Rep, class Period>
+        static clock::time_point deadline_after(const std::chrono::duration<Rep, Period>& timeout)
+        {
+            return clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+        }
+
+        template<class U>
+        bool push_once(U&& value)
+        {
+            if(!_queue.try_push(std::forward<U>(value)))
+                return false;
+
+            _pushes.notify();
+            return true;
+        }
+
+        bool pop_once(value_type& out)
+        {
+            if(!_queue.try_pop(out))
+                return false;
+
+            _pops.notify();
+            return true;
+        }
+
+        template<class U>
+        struct push_op {
+            blocking_circular_buffer* self;
+            U*                        value;
+
+            bool operator()() const { return self->push_once(std::forward<U>(*value)); }
+
+            bool more() const noexcept { return self->_queue.size() < N; }
+        };
+
+        struct pop_op {
+            blocking_circular_buffer* self;
+            value_type*               out;
+
+            bool operator()() const { return self->pop_once(*out); }
+
+            bool more() const noexcept { return !self->_queue.empty(); }
+        };
+
+    public:
+        blocking_circular_buffer() = default;
+
+        blocking_circular_buffer(const blocking_circular_buffer&) = delete;
+        blocking_circular_buffer& operator=(const blocking_circular_buffer&) = delete;
+
+        /// capacity, only approximate while other threads are running
+        bool empty() const noexcept { return _queue.empty(); }
+
+        size_type size() const noexcept { return _queue.size(); }
+
+        JM_CB_CONSTEXPR size_type max_size() const noexcept { return N; }
+
+        /// producers
+        bool try_push(const value_type& value) { return push_once(value); }
+
+        bool try_push(value_type&& value) { return push_once(std::move(value)); }
+
+        /// blocks until there is room for the element
+        void push(const value_type& value)
+        {
+            push_op<const value_type> op = { this, &value };
+            blocking(op, _pops, false, clock::time_point());
+        }
+
+        void push(value_type&& value)
+        {
+            push_op<value_type> op = { this, &value };
+            blocking(op, _pops, false, clock::time_point());
+        }
+
+        /// blocks for at most timeout, value is left untouched when it runs out
+        template<class Rep, class Period>
+        bool try_push_for(const value_type& value, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            push_op<const value_type> op = { this, &value };
+            return blocking(op, _pops, true, deadline_after(timeout));
+        }
+
+        template<class Rep, class Period>
+        bool try_push_for(value_type&& value, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            push_op<value_type> op = { this, &value };
+            return blocking(op, _pops, true, deadline_after(timeout));
+        }
+
+        /// consumers
+        bool try_pop(value_type& out) { return pop_once(out); }
+
+        /// blocks until there is an element to pop
+        void pop(value_type& out)
+        {
+            pop_op op = { this, &out };
+            blocking(op, _pushes, false, clock::time_point());
+        }
+
+        template<class Rep, class Period>
+        bool try_pop_for(value_type& out, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            pop_op op = { this, &out };
+            return blocking(op, _pushes, true, deadline_after(timeout));
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
@@ -20,10 +20,14 @@
 #include <iterator>
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
+#include <cstring>
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 #include <type_traits>
 #include <initializer_list>
+#include <cstdint>
+#include <memory>
 #endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
 
@@ -34,12 +38,22 @@
 #define JM_CB_ADDRESSOF(x) ::std::addressof(x)
 #define JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(type) \
     ::std::is_trivially_destructible<type>::value
+#define JM_CB_IS_TRIVIALLY_COPYABLE(type) ::std::is_trivially_copyable<type>::value
+#define JM_CB_STATIC_ASSERT(expr, msg) static_assert(expr, msg)
+#define JM_CB_ALIGNAS(x) alignas(x)
 #else
 #define JM_CB_CONSTEXPR
 #define JM_CB_NOEXCEPT
 #define JM_CB_NULLPTR NULL
 #define JM_CB_ADDRESSOF(x) &(x)
 #define JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(type) false
+#define JM_CB_IS_TRIVIALLY_COPYABLE(type) false
+#define JM_CB_STATIC_ASSERT(expr, msg)
+#define JM_CB_ALIGNAS(x)
+#endif
+
+#ifndef JM_CB_CACHE_LINE_SIZE
+#define JM_CB_CACHE_LINE_SIZE 64
 #endif
 
 #ifdef JM_CIRCULAR_BUFFER_CXX14
@@ -83,10 +97,101 @@
 
 namespace jm {
 
+    /// index policies, selecting how head and tail positions wrap around N
+
+    /// (value + 1) % N, works for any N
+    struct modulo_index {
+    };
+
+    /// (value + 1) & (N - 1), N must be a power of two
+    struct mask_index {
+    };
+
+    /// compares against N and resets to 0 without a division, works for any N
+    struct branchless_index {
+    };
+
+    /// free running read / write counters that are masked on access and the
+    /// size is derived from their difference, N must be a power of two
+    struct counter_index {
+    };
+
+    /// statistics policies
+
+    /// keeps no statistics and adds nothing to the buffer
+    struct no_stats {
+    };
+
+    /// counts pushes, pops, overwrites and tracks the peak size
+    struct basic_stats {
+    };
+
+    /// layout policies
+
+    /// the indices and the storage are laid out back to back
+    struct packed_layout {
+    };
+
+    /// the storage starts on its own cache line after the indices and the buffer is
+    /// padded to whole cache lines, so that neither the indices nor the elements of one
+    /// buffer share a line with a neighbouring object
+    struct cache_aligned_layout {
+    };
+
+    /// snapshot of the counters kept by basic_stats
+    struct circular_buffer_stats {
+        std::size_t pushes;
+        std::size_t pops;
+        std::size_t overwrites_front; // elements evicted from the front by push_back
+        std::size_t overwrites_back;  // elements evicted from the back by push_front
+        std::size_t peak_size;
+        std::size_t full_count; // how many times the buffer became full
+    };
+
     namespace detail {
 
-        template<class size_type, size_type N>
+#if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        // the narrowest unsigned type that can hold N. 16 bit indices are skipped, their
+        // compares against N need 16 bit immediates which stall the decoders of x86
+        // cores, while with 256 elements or more the saving is a few percent at best.
+        // Counters of counter_index wrap around at a power of two that is a multiple of
+        // N, which keeps them correct.
+        template<std::size_t N>
+        struct cb_index_type {
+            typedef typename std::conditional<
+                N <= 0xffu,
+                std::uint8_t,
+                typename std::conditional<N <= 0xffffffffu, std::uint32_t, std::size_t>::
+                    type>::type type;
+        };
+
+#else
+
+        template<std::size_t N>
+        struct cb_index_type {
+            typedef std::size_t type;
+        };
+
+#endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        // the type the index arithmetic is done in. Positions below N are computed on
+        // std::size_t and only stored narrow, which keeps the generated code free of
+        // 16 bit operations, free running counters have to wrap at the stored width.
+        template<std::size_t N, class Policy>
+        struct cb_position_type {
+            typedef std::size_t type;
+        };
+
+        template<std::size_t N>
+        struct cb_position_type<N, counter_index> {
+            typedef typename cb_index_type<N>::type type;
+        };
+
+        template<class size_type, size_type N, class Policy = modulo_index>
         struct cb_index_wrapper {
+            static const bool derives_size = false;
+
             inline static JM_CB_CONSTEXPR size_type increment(size_type value)
                 JM_CB_NOEXCEPT
             {
@@ -98,6 +203,294 @@ namespace jm {
             {
                 return (value + N - 1) % N;
             }
+
+            // n must not exceed N
+            inline static JM_CB_CONSTEXPR size_type add(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return (value + n) % N;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type sub(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return (value + N - n) % N;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type index(size_type value) JM_CB_NOEXCEPT
+            {
+                return value;
+            }
+        };
+
+        template<class size_type, size_type N>
+        struct cb_index_wrapper<size_type, N, mask_index> {
+            JM_CB_STATIC_ASSERT(N != 0 && (N & (N - 1)) == 0,
+                                "mask_index requires N to be a power of two");
+
+            static const bool derives_size = false;
+
+            inline static JM_CB_CONSTEXPR size_type increment(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return (value + 1) & (N - 1);
+            }
+
+            inline static JM_CB_CONSTEXPR size_type decrement(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return (value - 1) & (N - 1);
+            }
+
+            inline static JM_CB_CONSTEXPR size_type add(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return (value + n) & (N - 1);
+            }
+
+            inline static JM_CB_CONSTEXPR size_type sub(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return (value - n) & (N - 1);
+            }
+
+            inline static JM_CB_CONSTEXPR size_type index(size_type value) JM_CB_NOEXCEPT
+            {
+                return value;
+            }
+        };
+
+        template<class size_type, size_type N>
+        struct cb_index_wrapper<size_type, N, branchless_index> {
+            static const bool derives_size = false;
+
+            inline static JM_CB_CONSTEXPR size_type increment(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return value + 1 == N ? 0 : value + 1;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type decrement(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return value == 0 ? N - 1 : value - 1;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type add(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return value + n >= N ? value + n - N : value + n;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type sub(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return value >= n ? value - n : value + N - n;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type index(size_type value) JM_CB_NOEXCEPT
+            {
+                return value;
+            }
+        };
+
+        template<class size_type, size_type N>
+        struct cb_index_wrapper<size_type, N, counter_index> {
+            JM_CB_STATIC_ASSERT(N != 0 && (N & (N - 1)) == 0,
+                                "counter_index requires N to be a power of two");
+
+            static const bool derives_size = true;
+
+            inline static JM_CB_CONSTEXPR size_type increment(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return value + 1;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type decrement(size_type value)
+                JM_CB_NOEXCEPT
+            {
+                return value - 1;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type add(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return value + n;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type sub(size_type value, size_type n)
+                JM_CB_NOEXCEPT
+            {
+                return value - n;
+            }
+
+            inline static JM_CB_CONSTEXPR size_type index(size_type value) JM_CB_NOEXCEPT
+            {
+                return value & (N - 1);
+            }
+        };
+
+        // branchless_index with a capacity chosen at runtime
+        template<class size_type>
+        class cb_dynamic_index_wrapper {
+            size_type _capacity;
+
+        public:
+            static const bool derives_size = false;
+
+            explicit JM_CB_CONSTEXPR cb_dynamic_index_wrapper(size_type capacity = 0)
+                JM_CB_NOEXCEPT : _capacity(capacity)
+            {}
+
+            JM_CB_CONSTEXPR size_type capacity() const JM_CB_NOEXCEPT { return _capacity; }
+
+            JM_CB_CONSTEXPR size_type increment(size_type value) const JM_CB_NOEXCEPT
+            {
+                return value + 1 == _capacity ? 0 : value + 1;
+            }
+
+            JM_CB_CONSTEXPR size_type decrement(size_type value) const JM_CB_NOEXCEPT
+            {
+                return value == 0 ? _capacity - 1 : value - 1;
+            }
+
+            JM_CB_CONSTEXPR size_type add(size_type value, size_type n) const JM_CB_NOEXCEPT
+            {
+                return value + n >= _capacity ? value + n - _capacity : value + n;
+            }
+
+            JM_CB_CONSTEXPR size_type sub(size_type value, size_type n) const JM_CB_NOEXCEPT
+            {
+                return value >= n ? value - n : value + _capacity - n;
+            }
+
+            JM_CB_CONSTEXPR size_type index(size_type value) const JM_CB_NOEXCEPT
+            {
+                return value;
+            }
+        };
+
+        // storage and hooks of the statistics policy, no_stats is empty and its hooks
+        // compile to nothing
+        template<class size_type, size_type N, class Stats>
+        class cb_stats_base {
+        protected:
+            JM_CB_CXX14_CONSTEXPR void
+            record_push(size_type, size_type, size_type, bool) JM_CB_NOEXCEPT
+            {}
+
+            JM_CB_CXX14_CONSTEXPR void record_pop(size_type) JM_CB_NOEXCEPT {}
+
+            JM_CB_CONSTEXPR circular_buffer_stats get_stats() const JM_CB_NOEXCEPT
+            {
+                return circular_buffer_stats();
+            }
+
+            JM_CB_CXX14_CONSTEXPR void clear_stats(size_type) JM_CB_NOEXCEPT {}
+        };
+
+        template<class size_type, size_type N>
+        class cb_stats_base<size_type, N, basic_stats> {
+            circular_buffer_stats _stats;
+
+        protected:
+            JM_CB_CONSTEXPR cb_stats_base() JM_CB_NOEXCEPT : _stats() {}
+
+            // n elements were pushed, evicting evicted others and leaving new_size
+            JM_CB_CXX14_CONSTEXPR void record_push(size_type n,
+                                                   size_type evicted,
+                                                   size_type new_size,
+                                                   bool      at_front) JM_CB_NOEXCEPT
+            {
+                _stats.pushes += n;
+                if(at_front)
+                    _stats.overwrites_back += evicted;
+                else
+                    _stats.overwrites_front += evicted;
+
+                if(new_size > _stats.peak_size)
+                    _stats.peak_size = new_size;
+                if(new_size == N && new_size + evicted - n != N)
+                    ++_stats.full_count;
+            }
+
+            JM_CB_CXX14_CONSTEXPR void record_pop(size_type n) JM_CB_NOEXCEPT
+            {
+                _stats.pops += n;
+            }
+
+            JM_CB_CONSTEXPR circular_buffer_stats get_stats() const JM_CB_NOEXCEPT
+            {
+                return _stats;
+            }
+
+            JM_CB_CXX14_CONSTEXPR void clear_stats(size_type size) JM_CB_NOEXCEPT
+            {
+                _stats           = circular_buffer_stats();
+                _stats.peak_size = size;
+            }
+        };
+
+#if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        template<class Storage, class Layout>
+        struct cb_storage_alignment
+            : std::integral_constant<std::size_t, alignof(Storage)> {
+        };
+
+        template<class Storage>
+        struct cb_storage_alignment<Storage, cache_aligned_layout>
+            : std::integral_constant<std::size_t,
+                                     (alignof(Storage) > JM_CB_CACHE_LINE_SIZE
+                                          ? alignof(Storage)
+                                          : JM_CB_CACHE_LINE_SIZE)> {
+        };
+
+#endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        // keeps the element count next to head and tail
+        template<class size_type, bool Derived>
+        class cb_size_base {
+            size_type _size;
+
+        protected:
+            explicit JM_CB_CONSTEXPR cb_size_base(size_type size) JM_CB_NOEXCEPT
+                : _size(size)
+            {}
+
+            JM_CB_CONSTEXPR std::size_t get_size(size_type, size_type) const JM_CB_NOEXCEPT
+            {
+                return _size;
+            }
+
+            JM_CB_CXX14_CONSTEXPR void set_size(size_type size) JM_CB_NOEXCEPT
+            {
+                _size = size;
+            }
+
+            JM_CB_CXX14_CONSTEXPR void grow_size() JM_CB_NOEXCEPT { ++_size; }
+
+            JM_CB_CXX14_CONSTEXPR void shrink_size() JM_CB_NOEXCEPT { --_size; }
+        };
+
+        // derives the element count from free running head and tail counters
+        template<class size_type>
+        class cb_size_base<size_type, true> {
+        protected:
+            explicit JM_CB_CONSTEXPR cb_size_base(size_type) JM_CB_NOEXCEPT {}
+
+            JM_CB_CONSTEXPR std::size_t get_size(size_type head, size_type tail) const
+                JM_CB_NOEXCEPT
+            {
+                return static_cast<size_type>(tail - head + 1);
+            }
+
+            JM_CB_CXX14_CONSTEXPR void set_size(size_type) JM_CB_NOEXCEPT {}
+
+            JM_CB_CXX14_CONSTEXPR void grow_size() JM_CB_NOEXCEPT {}
+
+            JM_CB_CXX14_CONSTEXPR void shrink_size() JM_CB_NOEXCEPT {}
         };
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
@@ -112,6 +505,41 @@ namespace jm {
             return (std::move(arg));
         }
 
+        // whether a range of It can be copied into storage of T using memcpy
+        template<class It, class T>
+        struct cb_is_memcpyable : std::false_type {
+        };
+
+        template<class U, class T>
+        struct cb_is_memcpyable<U*, T>
+            : std::integral_constant<bool,
+                                     JM_CB_IS_TRIVIALLY_COPYABLE(T) &&
+                                         std::is_same<typename std::remove_cv<U>::type,
+                                                      T>::value> {
+        };
+
+        template<class T>
+        inline T* cb_to_address(T* ptr) noexcept
+        {
+            return ptr;
+        }
+
+#if defined(__cpp_lib_concepts) && defined(__cpp_lib_to_address)
+
+        template<class It, class T>
+        requires(std::contiguous_iterator<It> && !std::is_pointer<It>::value)
+        struct cb_is_memcpyable<It, T>
+            : cb_is_memcpyable<decltype(std::to_address(std::declval<It>())), T> {
+        };
+
+        template<class It>
+        inline auto cb_to_address(It it) noexcept -> decltype(std::to_address(it))
+        {
+            return std::to_address(it);
+        }
+
+#endif
+
         template<class T, bool = JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)>
         union optional_storage {
             struct empty_t {
@@ -178,50 +606,57 @@ namespace jm {
 
 #endif
 
-        template<class S, class TC, std::size_t N>
-        class cb_iterator {
-            template<class, class, std::size_t>
+        // the index wrapper is a base so that stateless wrappers take no space while
+        // runtime capacity wrappers travel with the iterator
+        template<class S, class TC, class Wrapper>
+        class cb_iterator : private Wrapper {
+            template<class, class, class>
             friend class cb_iterator;
 
             S*          _buf;
             std::size_t _pos;
             std::size_t _left_in_forward;
 
-            typedef detail::cb_index_wrapper<std::size_t, N> wrapper_t;
+            JM_CB_CONSTEXPR const Wrapper& wrapper() const JM_CB_NOEXCEPT { return *this; }
 
         public:
-            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef std::random_access_iterator_tag iterator_category;
             typedef TC                              value_type;
             typedef std::ptrdiff_t                  difference_type;
             typedef value_type*                     pointer;
             typedef value_type&                     reference;
 
-            explicit JM_CB_CONSTEXPR cb_iterator() JM_CB_NOEXCEPT : _buf(JM_CB_NULLPTR),
+            explicit JM_CB_CONSTEXPR cb_iterator() JM_CB_NOEXCEPT : Wrapper(),
+                                                                    _buf(JM_CB_NULLPTR),
                                                                     _pos(0),
                                                                     _left_in_forward(0)
             {}
 
             explicit JM_CB_CONSTEXPR
-            cb_iterator(S*          buf,
-                        std::size_t pos,
-                        std::size_t left_in_forward) JM_CB_NOEXCEPT
-                : _buf(buf),
+            cb_iterator(S*             buf,
+                        std::size_t    pos,
+                        std::size_t    left_in_forward,
+                        const Wrapper& wrapper = Wrapper()) JM_CB_NOEXCEPT
+                : Wrapper(wrapper),
+                  _buf(buf),
                   _pos(pos),
                   _left_in_forward(left_in_forward)
             {}
 
             template<class TSnc, class Tnc>
             JM_CB_CONSTEXPR
-            cb_iterator(const cb_iterator<TSnc, Tnc, N>& other) JM_CB_NOEXCEPT
-                : _buf(other._buf),
+            cb_iterator(const cb_iterator<TSnc, Tnc, Wrapper>& other) JM_CB_NOEXCEPT
+                : Wrapper(other.wrapper()),
+                  _buf(other._buf),
                   _pos(other._pos),
                   _left_in_forward(other._left_in_forward)
             {}
 
             template<class TSnc, class Tnc>
             JM_CB_CXX14_CONSTEXPR cb_iterator&
-                                  operator=(const cb_iterator<TSnc, Tnc, N>& other) JM_CB_NOEXCEPT
+                                  operator=(const cb_iterator<TSnc, Tnc, Wrapper>& other) JM_CB_NOEXCEPT
             {
+                static_cast<Wrapper&>(*this) = other.wrapper();
                 _buf             = other._buf;
                 _pos             = other._pos;
                 _left_in_forward = other._left_in_forward;
@@ -231,24 +666,24 @@ namespace jm {
 
             JM_CB_CONSTEXPR reference operator*() const JM_CB_NOEXCEPT
             {
-                return (_buf + _pos)->_value;
+                return (_buf + wrapper().index(_pos))->_value;
             }
 
             JM_CB_CONSTEXPR pointer operator->() const JM_CB_NOEXCEPT
             {
-                return JM_CB_ADDRESSOF((_buf + _pos)->_value);
+                return JM_CB_ADDRESSOF((_buf + wrapper().index(_pos))->_value);
             }
 
             JM_CB_CXX14_CONSTEXPR cb_iterator& operator++() JM_CB_NOEXCEPT
             {
-                _pos = wrapper_t::increment(_pos);
+                _pos = wrapper().increment(_pos);
                 --_left_in_forward;
                 return *this;
             }
 
             JM_CB_CXX14_CONSTEXPR cb_iterator& operator--() JM_CB_NOEXCEPT
             {
-                _pos = wrapper_t::decrement(_pos);
+                _pos = wrapper().decrement(_pos);
                 ++_left_in_forward;
                 return *this;
             }
@@ -256,22 +691,101 @@ namespace jm {
             JM_CB_CXX14_CONSTEXPR cb_iterator operator++(int)JM_CB_NOEXCEPT
             {
                 cb_iterator temp = *this;
-                _pos             = wrapper_t::increment(_pos);
+                _pos             = wrapper().increment(_pos);
                 --_left_in_forward;
                 return temp;
             }
 
-            JM_CB_CXX14_CONSTEXPR cb_iterator operator--(int)JM_CB_NOEXCEPT
+            JM_CB_CXX14_CONSTEXPR cb_iterator operator--(int)JM_CB_NOEXCEPT
+            {
+                cb_iterator temp = *this;
+                _pos             = wrapper().decrement(_pos);
+                ++_left_in_forward;
+                return temp;
+            }
+
+            JM_CB_CXX14_CONSTEXPR cb_iterator& operator+=(difference_type n) JM_CB_NOEXCEPT
+            {
+                if(n >= 0)
+                    _pos = wrapper().add(_pos, static_cast<std::size_t>(n));
+                else
+                    _pos = wrapper().sub(_pos, static_cast<std::size_t>(-n));
+
+                _left_in_forward -= n;
+                return *this;
+            }
+
+            JM_CB_CXX14_CONSTEXPR cb_iterator& operator-=(difference_type n) JM_CB_NOEXCEPT
+            {
+                return *this += -n;
+            }
+
+            JM_CB_CXX14_CONSTEXPR cb_iterator operator+(difference_type n) const
+                JM_CB_NOEXCEPT
+            {
+                cb_iterator temp = *this;
+                return temp += n;
+            }
+
+            friend JM_CB_CXX14_CONSTEXPR cb_iterator operator+(difference_type    n,
+                                                               const cb_iterator& it)
+                JM_CB_NOEXCEPT
+            {
+                return it + n;
+            }
+
+            JM_CB_CXX14_CONSTEXPR cb_iterator operator-(difference_type n) const
+                JM_CB_NOEXCEPT
+            {
+                cb_iterator temp = *this;
+                return temp -= n;
+            }
+
+            template<class Tx, class Ty>
+            JM_CB_CONSTEXPR difference_type
+            operator-(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
+            {
+                return static_cast<difference_type>(lhs._left_in_forward) -
+                       static_cast<difference_type>(_left_in_forward);
+            }
+
+            JM_CB_CXX14_CONSTEXPR reference operator[](difference_type n) const
+                JM_CB_NOEXCEPT
+            {
+                return *(*this + n);
+            }
+
+            template<class Tx, class Ty>
+            JM_CB_CONSTEXPR bool
+            operator<(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
+            {
+                return _left_in_forward > lhs._left_in_forward;
+            }
+
+            template<class Tx, class Ty>
+            JM_CB_CONSTEXPR bool
+            operator>(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
+            {
+                return _left_in_forward < lhs._left_in_forward;
+            }
+
+            template<class Tx, class Ty>
+            JM_CB_CONSTEXPR bool
+            operator<=(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
+            {
+                return _left_in_forward >= lhs._left_in_forward;
+            }
+
+            template<class Tx, class Ty>
+            JM_CB_CONSTEXPR bool
+            operator>=(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
             {
-                cb_iterator temp = *this;
-                _pos             = wrapper_t::decrement(_pos);
-                ++_left_in_forward;
-                return temp;
+                return _left_in_forward <= lhs._left_in_forward;
             }
 
             template<class Tx, class Ty>
             JM_CB_CONSTEXPR bool
-            operator==(const cb_iterator<Tx, Ty, N>& lhs) const JM_CB_NOEXCEPT
+            operator==(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
             {
                 return lhs._left_in_forward == _left_in_forward && lhs._pos == _pos &&
                        lhs._buf == _buf;
@@ -279,7 +793,7 @@ namespace jm {
 
             template<typename Tx, typename Ty>
             JM_CB_CONSTEXPR bool
-            operator!=(const cb_iterator<Tx, Ty, N>& lhs) const JM_CB_NOEXCEPT
+            operator!=(const cb_iterator<Tx, Ty, Wrapper>& lhs) const JM_CB_NOEXCEPT
             {
                 return !(operator==(lhs));
             }
@@ -288,34 +802,96 @@ namespace jm {
     } // namespace detail
 
 
-    template<typename T, std::size_t N>
-    class circular_buffer {
+    template<typename T,
+             std::size_t N,
+             class Index  = modulo_index,
+             class Stats  = no_stats,
+             class Layout = packed_layout>
+    class circular_buffer
+        : private detail::cb_size_base<
+              typename detail::cb_index_type<N>::type,
+              detail::cb_index_wrapper<std::size_t, N, Index>::derives_size>
+        , private detail::cb_stats_base<std::size_t, N, Stats> {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef Index          index_policy;
+        typedef Stats          stats_policy;
+        typedef Layout         layout_policy;
+
+        /// a contiguous run of elements as a (pointer, length) pair
+        typedef std::pair<pointer, size_type>       array_range;
+        typedef std::pair<const_pointer, size_type> const_array_range;
+
+        /// the (at most) two runs a request for several elements spans
+        typedef std::pair<array_range, array_range>             array_ranges;
+        typedef std::pair<const_array_range, const_array_range> const_array_ranges;
+
+    private:
+        // head, tail and the stored size use the narrowest type that holds N
+        typedef typename detail::cb_index_type<N>::type                    index_type;
+        typedef typename detail::cb_position_type<N, Index>::type          position_type;
+        typedef detail::cb_index_wrapper<position_type, N, Index>          wrapper_t;
+        typedef detail::cb_size_base<index_type, wrapper_t::derives_size> size_base;
+        typedef detail::cb_stats_base<size_type, N, Stats>                 stats_base;
+        typedef detail::optional_storage<T>                                storage_type;
+
     public:
-        typedef T                                                      value_type;
-        typedef std::size_t                                            size_type;
-        typedef std::ptrdiff_t                                         difference_type;
-        typedef T&                                                     reference;
-        typedef const T&                                               const_reference;
-        typedef T*                                                     pointer;
-        typedef const T*                                               const_pointer;
-        typedef detail::cb_iterator<detail::optional_storage<T>, T, N> iterator;
-        typedef detail::cb_iterator<const detail::optional_storage<T>, const T, N>
+        typedef detail::cb_iterator<storage_type, T, wrapper_t> iterator;
+        typedef detail::cb_iterator<const storage_type, const T, wrapper_t>
                                                       const_iterator;
         typedef std::reverse_iterator<iterator>       reverse_iterator;
         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
     private:
-        typedef detail::cb_index_wrapper<size_type, N> wrapper_t;
-        typedef detail::optional_storage<T>            storage_type;
+        JM_CB_STATIC_ASSERT(sizeof(storage_type) == sizeof(T) &&
+                                alignof(storage_type) == alignof(T),
+                            "storage must be layout compatible with an array of T");
 
-        size_type    _head;
-        size_type    _tail;
-        size_type    _size;
+        index_type _head;
+        index_type _tail;
+        JM_CB_ALIGNAS((detail::cb_storage_alignment<storage_type, Layout>::value))
         storage_type _buffer[N];
 
-        inline void destroy(size_type idx) JM_CB_NOEXCEPT { _buffer[idx]._value.~T(); }
+        JM_CB_CONSTEXPR size_type head_index() const JM_CB_NOEXCEPT
+        {
+            return wrapper_t::index(_head);
+        }
+
+        JM_CB_CONSTEXPR size_type free_index() const JM_CB_NOEXCEPT
+        {
+            return wrapper_t::index(wrapper_t::increment(_tail));
+        }
 
-        inline void copy_buffer(const circular_buffer& other)
+        JM_CB_CONSTEXPR size_type array_one_size() const JM_CB_NOEXCEPT
+        {
+            return (std::min)(size(), N - head_index());
+        }
+
+        JM_CB_CONSTEXPR size_type free_array_one_size() const JM_CB_NOEXCEPT
+        {
+            return (std::min)(N - size(), N - free_index());
+        }
+
+        inline void destroy(size_type pos) JM_CB_NOEXCEPT
+        {
+            _buffer[wrapper_t::index(pos)]._value.~T();
+        }
+
+        // destroys the last n elements without touching the indices
+        JM_CB_CXX14_CONSTEXPR void destroy_back(size_type n) JM_CB_NOEXCEPT
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T))
+                for(size_type i = 0, pos = _tail; i < n; ++i, pos = wrapper_t::decrement(pos))
+                    destroy(pos);
+        }
+
+        inline void copy_elements(const circular_buffer& other)
         {
             const_iterator       first = other.cbegin();
             const const_iterator last  = other.cend();
@@ -324,10 +900,57 @@ namespace jm {
                 push_back(*first);
         }
 
+        inline void copy_buffer(const circular_buffer& other)
+        {
+#if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+            copy_buffer(other, trivially_copyable());
+#else
+            copy_elements(other);
+#endif
+        }
+
+        // the counters travel with the contents, the element by element copies and
+        // moves have recorded pushes of their own that are discarded here
+        inline void copy_stats(const circular_buffer& other) JM_CB_NOEXCEPT
+        {
+            static_cast<stats_base&>(*this) = other;
+        }
+
+        JM_CB_CXX14_CONSTEXPR void reset_indices() JM_CB_NOEXCEPT
+        {
+            this->set_size(0);
+            _head = 0;
+            _tail = wrapper_t::decrement(0);
+        }
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
-        inline void move_buffer(circular_buffer&& other)
+        typedef std::integral_constant<bool, JM_CB_IS_TRIVIALLY_COPYABLE(T)> trivially_copyable;
+
+        // trivially copyable elements are copied with at most two memcpy calls and end
+        // up linearized at the start of the storage
+        inline void copy_buffer(const circular_buffer& other, std::true_type) JM_CB_NOEXCEPT
+        {
+            const size_type n = other.size();
+            if(n != 0)
+                other.copy_out(other._head, data(), n);
+
+            _head = 0;
+            _tail = wrapper_t::decrement(n);
+            this->set_size(n);
+        }
+
+        inline void copy_buffer(const circular_buffer& other, std::false_type)
+        {
+            copy_elements(other);
+        }
+
+        inline void move_buffer(circular_buffer&& other, std::true_type) JM_CB_NOEXCEPT
+        {
+            copy_buffer(other, std::true_type());
+        }
+
+        inline void move_buffer(circular_buffer&& other, std::false_type)
         {
             iterator       first = other.begin();
             const iterator last  = other.end();
@@ -336,127 +959,407 @@ namespace jm {
                 emplace_back(std::move(*first));
         }
 
+        typedef std::pair<size_type, size_type> slot_range; // [first, last) slot indices
+
+        // the slots holding elements as at most two ranges, returns how many were written
+        inline size_type live_slots(slot_range* out) const JM_CB_NOEXCEPT
+        {
+            const size_type head  = head_index();
+            const size_type first = (std::min)(size(), N - head);
+
+            size_type count = 0;
+            if(first != 0)
+                out[count++] = slot_range(head, head + first);
+            if(first != size())
+                out[count++] = slot_range(0, size() - first);
+
+            return count;
+        }
+
+        // exchanges the raw bytes of the slots that hold an element in either buffer,
+        // the indices travel along so the elements keep their slots. The cost follows
+        // the number of elements and not N.
+        inline void swap_buffer(circular_buffer& other, std::true_type) JM_CB_NOEXCEPT
+        {
+            slot_range ranges[4];
+            size_type  count = live_slots(ranges);
+            count += other.live_slots(ranges + count);
+            std::sort(ranges, ranges + count);
+
+            for(size_type i = 0; i < count;) {
+                const size_type first = ranges[i].first;
+                size_type       last  = ranges[i].second;
+                for(++i; i < count && ranges[i].first <= last; ++i)
+                    last = (std::max)(last, ranges[i].second);
+
+                unsigned char* lhs = reinterpret_cast<unsigned char*>(_buffer + first);
+                std::swap_ranges(lhs,
+                                 lhs + (last - first) * sizeof(storage_type),
+                                 reinterpret_cast<unsigned char*>(other._buffer + first));
+            }
+
+            const size_type size = this->size();
+            this->set_size(other.size());
+            other.set_size(size);
+            std::swap(_head, other._head);
+            std::swap(_tail, other._tail);
+            std::swap(static_cast<stats_base&>(*this), static_cast<stats_base&>(other));
+        }
+
+        inline void swap_buffer(circular_buffer& other, std::false_type)
+        {
+            circular_buffer tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        // copies n <= N elements to the slots starting at logical position pos
+        // with at most two memcpy calls
+        inline void copy_in(size_type pos, const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            const size_type idx   = wrapper_t::index(pos);
+            const size_type first = (std::min)(n, N - idx);
+
+            std::memcpy(JM_CB_ADDRESSOF(_buffer[idx]._value), src, first * sizeof(T));
+            if(first != n)
+                std::memcpy(JM_CB_ADDRESSOF(_buffer[0]._value),
+                            src + first,
+                            (n - first) * sizeof(T));
+        }
+
+        // the mirror of copy_in, copies n <= size() elements starting at logical position pos
+        inline void copy_out(size_type pos, T* dst, size_type n) const JM_CB_NOEXCEPT
+        {
+            const size_type idx   = wrapper_t::index(pos);
+            const size_type first = (std::min)(n, N - idx);
+
+            std::memcpy(dst, JM_CB_ADDRESSOF(_buffer[idx]._value), first * sizeof(T));
+            if(first != n)
+                std::memcpy(dst + first,
+                            JM_CB_ADDRESSOF(_buffer[0]._value),
+                            (n - first) * sizeof(T));
+        }
+
+        template<class ContiguousIt>
+        void read_n(ContiguousIt dst, size_type n, std::true_type) const JM_CB_NOEXCEPT
+        {
+            copy_out(_head, detail::cb_to_address(dst), n);
+        }
+
+        template<class OutputIt>
+        void read_n(OutputIt dst, size_type n, std::false_type)
+        {
+            const size_type first = (std::min)(n, array_one_size());
+            T*              one   = JM_CB_ADDRESSOF(_buffer[head_index()]._value);
+
+            dst = std::move(one, one + first, dst);
+            std::move(JM_CB_ADDRESSOF(_buffer[0]._value),
+                      JM_CB_ADDRESSOF(_buffer[0]._value) + (n - first),
+                      dst);
+        }
+
+        void push_back_n(const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            if(JM_CB_UNLIKELY(n == 0))
+                return;
+
+            const size_type pushed  = n;
+            const size_type evicted = size() + n > N ? size() + n - N : 0;
+            if(n >= N) {
+                src += n - N;
+                n = N;
+                reset_indices();
+            }
+
+            const size_type old_size = size();
+            const size_type overflow = old_size + n > N ? old_size + n - N : 0;
+
+            copy_in(wrapper_t::increment(_tail), src, n);
+            _tail = wrapper_t::add(_tail, n);
+            _head = wrapper_t::add(_head, overflow);
+            this->set_size(old_size + n - overflow);
+            this->record_push(pushed, evicted, size(), false);
+        }
+
+        void push_front_n(const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            if(JM_CB_UNLIKELY(n == 0))
+                return;
+
+            const size_type pushed  = n;
+            const size_type evicted = size() + n > N ? size() + n - N : 0;
+            if(n >= N) {
+                n = N;
+                reset_indices();
+            }
+
+            const size_type old_size = size();
+            const size_type overflow = old_size + n > N ? old_size + n - N : 0;
+            const size_type new_head = wrapper_t::sub(_head, n);
+
+            copy_in(new_head, src, n);
+            _head = new_head;
+            _tail = wrapper_t::sub(_tail, overflow);
+            this->set_size(old_size + n - overflow);
+            this->record_push(pushed, evicted, size(), true);
+        }
+
+        template<class InputIt>
+        void push_back_range(InputIt first, InputIt last, std::input_iterator_tag, std::false_type)
+        {
+            for(; first != last; ++first)
+                push_back(*first);
+        }
+
+        template<class ForwardIt>
+        void
+        push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag, std::false_type)
+        {
+            const size_type n = static_cast<size_type>(std::distance(first, last));
+            if(n > N) {
+                // the skipped elements count as pushed and overwritten right away
+                std::advance(first, n - N);
+                this->record_push(n - N, n - N, size(), false);
+            }
+
+            for(; first != last; ++first)
+                push_back(*first);
+        }
+
+        template<class ContiguousIt>
+        void push_back_range(ContiguousIt first,
+                             ContiguousIt last,
+                             std::random_access_iterator_tag,
+                             std::true_type) JM_CB_NOEXCEPT
+        {
+            push_back_n(detail::cb_to_address(first), static_cast<size_type>(last - first));
+        }
+
+        template<class BidirIt>
+        void push_front_range(BidirIt first, BidirIt last, std::false_type)
+        {
+            const size_type n = static_cast<size_type>(std::distance(first, last));
+            if(n > N) {
+                last = first;
+                std::advance(last, N);
+                this->record_push(n - N, n - N, size(), true);
+            }
+
+            while(last != first)
+                push_front(*--last);
+        }
+
+        template<class ContiguousIt>
+        void push_front_range(ContiguousIt first, ContiguousIt last, std::true_type) JM_CB_NOEXCEPT
+        {
+            push_front_n(detail::cb_to_address(first), static_cast<size_type>(last - first));
+        }
+
+        template<class InputIt>
+        void construct_range(InputIt first, InputIt last, std::false_type)
+        {
+            size_type count = 0;
+            for(; first != last; ++first, ++count) {
+                if(JM_CB_UNLIKELY(count >= N))
+                    throw std::out_of_range(
+                        "circular_buffer<T, N>(InputIt first, InputIt last) distance exceeded N");
+
+                new(JM_CB_ADDRESSOF(_buffer[count]._value)) T(*first);
+            }
+
+            this->set_size(count);
+            _tail = wrapper_t::decrement(count);
+            this->record_push(count, 0, count, false);
+        }
+
+        template<class ContiguousIt>
+        void construct_range(ContiguousIt first, ContiguousIt last, std::true_type)
+        {
+            if(JM_CB_UNLIKELY(last - first > static_cast<difference_type>(N)))
+                throw std::out_of_range(
+                    "circular_buffer<T, N>(InputIt first, InputIt last) distance exceeded N");
+
+            push_back_n(detail::cb_to_address(first), static_cast<size_type>(last - first));
+        }
+
 #endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
     public:
         JM_CB_CONSTEXPR explicit circular_buffer()
-            : _head(1), _tail(0), _size(0), _buffer()
+            : size_base(0), stats_base(), _head(0), _tail(wrapper_t::decrement(0)), _buffer()
         {}
 
 #if defined(JM_CIRCULAR_BUFFER_CXX_OLD)
         explicit
 #endif
             circular_buffer(size_type count, const T& value = T())
-            : _head(0), _tail(count - 1), _size(count), _buffer()
+            : size_base(count)
+            , stats_base()
+            , _head(0)
+            , _tail(wrapper_t::decrement(count))
+            , _buffer()
         {
-            if(JM_CB_UNLIKELY(_size > N))
+            if(JM_CB_UNLIKELY(count > N))
                 throw std::out_of_range(
                     "circular_buffer<T, N>(size_type count, const T&) count exceeded N");
 
-            if(JM_CB_LIKELY(_size != 0))
-                for(size_type i = 0; i < count; ++i)
-                    new(JM_CB_ADDRESSOF(_buffer[i]._value)) T(value);
-            else
-                _head = 1;
+            for(size_type i = 0; i < count; ++i)
+                new(JM_CB_ADDRESSOF(_buffer[i]._value)) T(value);
+
+            this->record_push(count, 0, count, false);
         }
 
         template<typename InputIt>
         circular_buffer(InputIt first, InputIt last)
-            : _head(0), _tail(0), _size(0), _buffer()
+            : size_base(0), stats_base(), _head(0), _tail(wrapper_t::decrement(0)), _buffer()
         {
-            if(first != last) {
-                for(; first != last; ++first, ++_size) {
-                    if(JM_CB_UNLIKELY(_size >= N))
-                        throw std::out_of_range(
-                            "circular_buffer<T, N>(InputIt first, InputIt last) distance exceeded N");
-
-                    new(JM_CB_ADDRESSOF(_buffer[_size]._value)) T(*first);
-                }
+#if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+            construct_range(first, last, detail::cb_is_memcpyable<InputIt, T>());
+#else
+            size_type count = 0;
+            for(; first != last; ++first, ++count) {
+                if(JM_CB_UNLIKELY(count >= N))
+                    throw std::out_of_range(
+                        "circular_buffer<T, N>(InputIt first, InputIt last) distance exceeded N");
 
-                _tail = _size - 1;
+                new(JM_CB_ADDRESSOF(_buffer[count]._value)) T(*first);
             }
-            else
-                _head = 1;
+
+            this->set_size(count);
+            _tail = wrapper_t::decrement(count);
+            this->record_push(count, 0, count, false);
+#endif
         }
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
         circular_buffer(std::initializer_list<T> init)
-            : _head(0), _tail(init.size() - 1), _size(init.size()), _buffer()
+            : size_base(init.size())
+            , stats_base()
+            , _head(0)
+            , _tail(wrapper_t::decrement(init.size()))
+            , _buffer()
         {
-            if(JM_CB_UNLIKELY(_size > N))
+            if(JM_CB_UNLIKELY(init.size() > N))
                 throw std::out_of_range(
                     "circular_buffer<T, N>(std::initializer_list<T> init) init.size() > N");
 
-            if(JM_CB_UNLIKELY(_size == 0))
-                _head = 1;
-
             storage_type* buf_ptr = _buffer;
             for(auto it = init.begin(), end = init.end(); it != end; ++it, ++buf_ptr)
                 new(JM_CB_ADDRESSOF(buf_ptr->_value)) T(*it);
+
+            this->record_push(init.size(), 0, init.size(), false);
         }
 
 #endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
         circular_buffer(const circular_buffer& other)
-            : _head(1), _tail(0), _size(0), _buffer()
+            : size_base(0), stats_base(), _head(0), _tail(wrapper_t::decrement(0)), _buffer()
         {
             copy_buffer(other);
+            copy_stats(other);
         }
 
         circular_buffer& operator=(const circular_buffer& other)
         {
-            clear();
-            copy_buffer(other);
+            if(this != JM_CB_ADDRESSOF(other)) {
+                clear();
+                copy_buffer(other);
+                copy_stats(other);
+            }
+
             return *this;
         }
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
-        circular_buffer(circular_buffer&& other) : _head(1), _tail(0), _size(0), _buffer()
+        circular_buffer(circular_buffer&& other)
+            : size_base(0), stats_base(), _head(0), _tail(wrapper_t::decrement(0)), _buffer()
         {
-            move_buffer(std::move(other));
+            move_buffer(std::move(other), trivially_copyable());
+            copy_stats(other);
         }
 
         circular_buffer& operator=(circular_buffer&& other)
         {
-            clear();
-            move_buffer(std::move(other));
+            if(this != JM_CB_ADDRESSOF(other)) {
+                clear();
+                move_buffer(std::move(other), trivially_copyable());
+                copy_stats(other);
+            }
+
             return *this;
         }
 
+        /// trivially copyable elements are swapped as raw storage, others through moves
+        void swap(circular_buffer& other)
+        {
+            swap_buffer(other, trivially_copyable());
+        }
+
+        friend void swap(circular_buffer& lhs, circular_buffer& rhs) { lhs.swap(rhs); }
+
 #endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
         ~circular_buffer() { clear(); }
 
         /// capacity
-        JM_CB_CONSTEXPR bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
+        JM_CB_CONSTEXPR bool empty() const JM_CB_NOEXCEPT { return size() == 0; }
 
-        JM_CB_CONSTEXPR bool full() const JM_CB_NOEXCEPT { return _size == N; }
+        JM_CB_CONSTEXPR bool full() const JM_CB_NOEXCEPT { return size() == N; }
 
-        JM_CB_CONSTEXPR size_type size() const JM_CB_NOEXCEPT { return _size; }
+        JM_CB_CONSTEXPR size_type size() const JM_CB_NOEXCEPT
+        {
+            return this->get_size(_head, _tail);
+        }
 
         JM_CB_CONSTEXPR size_type max_size() const JM_CB_NOEXCEPT { return N; }
 
         /// element access
         JM_CB_CXX14_CONSTEXPR reference front() JM_CB_NOEXCEPT
         {
-            return _buffer[_head]._value;
+            return _buffer[wrapper_t::index(_head)]._value;
         }
 
         JM_CB_CONSTEXPR const_reference front() const JM_CB_NOEXCEPT
         {
-            return _buffer[_head]._value;
+            return _buffer[wrapper_t::index(_head)]._value;
+        }
+
+        JM_CB_CXX14_CONSTEXPR reference operator[](size_type pos) JM_CB_NOEXCEPT
+        {
+            return _buffer[wrapper_t::index(wrapper_t::add(_head, pos))]._value;
+        }
+
+        JM_CB_CONSTEXPR const_reference operator[](size_type pos) const JM_CB_NOEXCEPT
+        {
+            return _buffer[wrapper_t::index(wrapper_t::add(_head, pos))]._value;
+        }
+
+        JM_CB_CXX14_CONSTEXPR reference at(size_type pos)
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range("circular_buffer<T, N>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
+        }
+
+        JM_CB_CXX14_CONSTEXPR const_reference at(size_type pos) const
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range("circular_buffer<T, N>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
         }
 
         JM_CB_CXX14_CONSTEXPR reference back() JM_CB_NOEXCEPT
         {
-            return _buffer[_tail]._value;
+            return _buffer[wrapper_t::index(_tail)]._value;
         }
 
         JM_CB_CONSTEXPR const_reference back() const JM_CB_NOEXCEPT
         {
-            return _buffer[_tail]._value;
+            return _buffer[wrapper_t::index(_tail)]._value;
         }
 
         JM_CB_CXX14_CONSTEXPR pointer data() JM_CB_NOEXCEPT
@@ -469,119 +1372,309 @@ namespace jm {
             return JM_CB_ADDRESSOF(_buffer[0]._value);
         }
 
+        /// the elements in logical order as at most two contiguous runs,
+        /// array_two is empty unless the elements wrap around the end of the storage
+        JM_CB_CXX14_CONSTEXPR array_range array_one() JM_CB_NOEXCEPT
+        {
+            return array_range(JM_CB_ADDRESSOF(_buffer[head_index()]._value),
+                               array_one_size());
+        }
+
+        JM_CB_CONSTEXPR const_array_range array_one() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(JM_CB_ADDRESSOF(_buffer[head_index()]._value),
+                                     array_one_size());
+        }
+
+        JM_CB_CXX14_CONSTEXPR array_range array_two() JM_CB_NOEXCEPT
+        {
+            return array_range(JM_CB_ADDRESSOF(_buffer[0]._value),
+                               size() - array_one_size());
+        }
+
+        JM_CB_CONSTEXPR const_array_range array_two() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(JM_CB_ADDRESSOF(_buffer[0]._value),
+                                     size() - array_one_size());
+        }
+
+        /// the uninitialized storage after back() as at most two contiguous runs
+        JM_CB_CXX14_CONSTEXPR array_range free_array_one() JM_CB_NOEXCEPT
+        {
+            return array_range(JM_CB_ADDRESSOF(_buffer[free_index()]._value),
+                               free_array_one_size());
+        }
+
+        JM_CB_CXX14_CONSTEXPR array_range free_array_two() JM_CB_NOEXCEPT
+        {
+            return array_range(JM_CB_ADDRESSOF(_buffer[0]._value),
+                               N - size() - free_array_one_size());
+        }
+
+        /// in place producer and consumer access
+        /// up to n uninitialized slots after back() as at most two contiguous runs, fewer
+        /// when there is less free space. Elements constructed there in order, starting
+        /// with the first run, become part of the buffer with commit_back().
+        JM_CB_CXX14_CONSTEXPR array_ranges reserve_back(size_type n) JM_CB_NOEXCEPT
+        {
+            n                     = (std::min)(n, N - size());
+            const size_type first = (std::min)(n, free_array_one_size());
+            return array_ranges(array_range(JM_CB_ADDRESSOF(_buffer[free_index()]._value), first),
+                                array_range(data(), n - first));
+        }
+
+        /// appends the first n elements constructed in the slots returned by the last
+        /// reserve_back(), n must not exceed the number of slots it returned
+        JM_CB_CXX14_CONSTEXPR void commit_back(size_type n) JM_CB_NOEXCEPT
+        {
+            _tail = wrapper_t::add(_tail, n);
+            this->set_size(size() + n);
+            this->record_push(n, 0, size(), false);
+        }
+
+        /// the first min(n, size()) elements as at most two contiguous runs
+        JM_CB_CXX14_CONSTEXPR array_ranges peek_front(size_type n) JM_CB_NOEXCEPT
+        {
+            n                     = (std::min)(n, size());
+            const size_type first = (std::min)(n, array_one_size());
+            return array_ranges(array_range(JM_CB_ADDRESSOF(_buffer[head_index()]._value), first),
+                                array_range(data(), n - first));
+        }
+
+        JM_CB_CXX14_CONSTEXPR const_array_ranges peek_front(size_type n) const JM_CB_NOEXCEPT
+        {
+            n                     = (std::min)(n, size());
+            const size_type first = (std::min)(n, array_one_size());
+            return const_array_ranges(
+                const_array_range(JM_CB_ADDRESSOF(_buffer[head_index()]._value), first),
+                const_array_range(data(), n - first));
+        }
+
+        /// removes the first n elements once they have been processed through peek_front(),
+        /// n must not exceed size()
+        JM_CB_CXX14_CONSTEXPR void consume_front(size_type n) JM_CB_NOEXCEPT { pop_front(n); }
+
         /// modifiers
         void push_back(const value_type& value)
         {
-            size_type new_tail;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_tail = _head;
-                _head    = wrapper_t::increment(_head);
-                --_size;
-                _buffer[new_tail]._value = value;
+            const size_type new_tail = wrapper_t::increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _head                                       = wrapper_t::increment(_head);
+                _buffer[wrapper_t::index(new_tail)]._value = value;
+                this->record_push(1, 1, N, false);
             }
             else {
-                new_tail = wrapper_t::increment(_tail);
-                new(JM_CB_ADDRESSOF(_buffer[new_tail]._value)) T(value);
+                new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_tail)]._value)) T(value);
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(_head, new_tail), false);
             }
 
             _tail = new_tail;
-            ++_size;
         }
 
         void push_front(const value_type& value)
         {
-            size_type new_head = 0;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_head = _tail;
-                _tail    = wrapper_t::decrement(_tail);
-                --_size;
-                _buffer[new_head]._value = value;
+            const size_type new_head = wrapper_t::decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _tail                                       = wrapper_t::decrement(_tail);
+                _buffer[wrapper_t::index(new_head)]._value = value;
+                this->record_push(1, 1, N, true);
             }
             else {
-                new_head = wrapper_t::decrement(_head);
-                new(JM_CB_ADDRESSOF(_buffer[new_head]._value)) T(value);
+                new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_head)]._value)) T(value);
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(new_head, _tail), true);
             }
 
             _head = new_head;
-            ++_size;
+        }
+
+        /// appends value unless the buffer is full, in which case nothing is
+        /// constructed, the contents are left untouched and false is returned
+        bool try_push_back(const value_type& value)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_tail = wrapper_t::increment(_tail);
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_tail)]._value)) T(value);
+            this->grow_size();
+            this->record_push(1, 0, this->get_size(_head, new_tail), false);
+            _tail = new_tail;
+            return true;
+        }
+
+        /// prepends value unless the buffer is full
+        bool try_push_front(const value_type& value)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_head = wrapper_t::decrement(_head);
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_head)]._value)) T(value);
+            this->grow_size();
+            this->record_push(1, 0, this->get_size(new_head, _tail), true);
+            _head = new_head;
+            return true;
         }
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
 
+        bool try_push_back(value_type&& value) { return try_emplace_back(std::move(value)); }
+
+        bool try_push_front(value_type&& value) { return try_emplace_front(std::move(value)); }
+
         void push_back(value_type&& value)
         {
-            size_type new_tail;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_tail = _head;
-                _head    = wrapper_t::increment(_head);
-                --_size;
-                _buffer[new_tail]._value = detail::move_if_noexcept_assign(value);
+            const size_type new_tail = wrapper_t::increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _head = wrapper_t::increment(_head);
+                _buffer[wrapper_t::index(new_tail)]._value =
+                    detail::move_if_noexcept_assign(value);
+                this->record_push(1, 1, N, false);
             }
             else {
-                new_tail = wrapper_t::increment(_tail);
-                new(JM_CB_ADDRESSOF(_buffer[new_tail]._value))
+                new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_tail)]._value))
                     T(std::move_if_noexcept(value));
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(_head, new_tail), false);
             }
 
             _tail = new_tail;
-            ++_size;
         }
 
         void push_front(value_type&& value)
         {
-            size_type new_head = 0;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_head = _tail;
-                _tail    = wrapper_t::decrement(_tail);
-                --_size;
-                _buffer[new_head]._value = detail::move_if_noexcept_assign(value);
+            const size_type new_head = wrapper_t::decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _tail = wrapper_t::decrement(_tail);
+                _buffer[wrapper_t::index(new_head)]._value =
+                    detail::move_if_noexcept_assign(value);
+                this->record_push(1, 1, N, true);
             }
             else {
-                new_head = wrapper_t::decrement(_head);
-                new(JM_CB_ADDRESSOF(_buffer[new_head]._value))
+                new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_head)]._value))
                     T(std::move_if_noexcept(value));
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(new_head, _tail), true);
             }
 
             _head = new_head;
-            ++_size;
+        }
+
+        /// appends [first, last) as if by push_back of every element, only the last N
+        /// elements of a longer range are written. Contiguous ranges of trivially
+        /// copyable T are copied with at most two memcpy calls.
+        template<typename InputIt,
+                 typename std::enable_if<!std::is_integral<InputIt>::value, int>::type = 0>
+        void push_back(InputIt first, InputIt last)
+        {
+            push_back_range(first,
+                            last,
+                            typename std::iterator_traits<InputIt>::iterator_category(),
+                            detail::cb_is_memcpyable<InputIt, T>());
+        }
+
+        /// prepends [first, last) keeping its order so that front() == *first,
+        /// only the first N elements of a longer range are written
+        template<typename BidirIt,
+                 typename std::enable_if<!std::is_integral<BidirIt>::value, int>::type = 0>
+        void push_front(BidirIt first, BidirIt last)
+        {
+            push_front_range(first, last, detail::cb_is_memcpyable<BidirIt, T>());
+        }
+
+        /// replaces the contents with [first, last), keeping the last N elements
+        template<typename InputIt,
+                 typename std::enable_if<!std::is_integral<InputIt>::value, int>::type = 0>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            push_back(first, last);
+        }
+
+        /// replaces the contents with min(count, N) copies of value
+        void assign(size_type count, const T& value)
+        {
+            clear();
+            for(count = (std::min)(count, N); count != 0; --count)
+                push_back(value);
+        }
+
+        void assign(std::initializer_list<T> init)
+        {
+            clear();
+            push_back(init.begin(), init.end());
         }
 
         template<typename... Args>
         void emplace_back(Args&&... args)
         {
-            size_type new_tail;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_tail = _head;
-                _head    = wrapper_t::increment(_head);
-                --_size;
+            const size_type new_tail = wrapper_t::increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _head = wrapper_t::increment(_head);
                 destroy(new_tail);
+                this->record_push(1, 1, N, false);
+            }
+            else {
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(_head, new_tail), false);
             }
-            else
-                new_tail = wrapper_t::increment(_tail);
 
-            new(JM_CB_ADDRESSOF(_buffer[new_tail]._value))
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_tail)]._value))
                 value_type(std::forward<Args>(args)...);
             _tail = new_tail;
-            ++_size;
         }
 
         template<typename... Args>
         void emplace_front(Args&&... args)
         {
-            size_type new_head;
-            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
-                new_head = _tail;
-                _tail    = wrapper_t::decrement(_tail);
-                --_size;
+            const size_type new_head = wrapper_t::decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                _tail = wrapper_t::decrement(_tail);
                 destroy(new_head);
+                this->record_push(1, 1, N, true);
+            }
+            else {
+                this->grow_size();
+                this->record_push(1, 0, this->get_size(new_head, _tail), true);
             }
-            else
-                new_head = wrapper_t::decrement(_head);
 
-            new(JM_CB_ADDRESSOF(_buffer[new_head]._value))
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_head)]._value))
+                value_type(std::forward<Args>(args)...);
+            _head = new_head;
+        }
+
+        /// constructs the element in place unless the buffer is full, the arguments are
+        /// not touched when false is returned
+        template<typename... Args>
+        bool try_emplace_back(Args&&... args)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_tail = wrapper_t::increment(_tail);
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_tail)]._value))
                 value_type(std::forward<Args>(args)...);
+            this->grow_size();
+            this->record_push(1, 0, this->get_size(_head, new_tail), false);
+            _tail = new_tail;
+            return true;
+        }
+
+        template<typename... Args>
+        bool try_emplace_front(Args&&... args)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_head = wrapper_t::decrement(_head);
+            new(JM_CB_ADDRESSOF(_buffer[wrapper_t::index(new_head)]._value))
+                value_type(std::forward<Args>(args)...);
+            this->grow_size();
+            this->record_push(1, 0, this->get_size(new_head, _tail), true);
             _head = new_head;
-            ++_size;
+            return true;
         }
 
 #endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
@@ -589,69 +1682,110 @@ namespace jm {
         JM_CB_CXX14_CONSTEXPR void pop_back() JM_CB_NOEXCEPT
         {
             size_type old_tail = _tail;
-            --_size;
+            this->shrink_size();
             _tail = wrapper_t::decrement(_tail);
             destroy(old_tail);
+            this->record_pop(1);
         }
 
         JM_CB_CXX14_CONSTEXPR void pop_front() JM_CB_NOEXCEPT
         {
             size_type old_head = _head;
-            --_size;
+            this->shrink_size();
             _head = wrapper_t::increment(_head);
             destroy(old_head);
+            this->record_pop(1);
+        }
+
+        /// removes the first n elements, n must not exceed size()
+        JM_CB_CXX14_CONSTEXPR void pop_front(size_type n) JM_CB_NOEXCEPT
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T))
+                for(size_type i = 0, pos = _head; i < n; ++i, pos = wrapper_t::increment(pos))
+                    destroy(pos);
+
+            this->set_size(size() - n);
+            _head = wrapper_t::add(_head, n);
+            this->record_pop(n);
+        }
+
+        /// removes the last n elements, n must not exceed size()
+        JM_CB_CXX14_CONSTEXPR void pop_back(size_type n) JM_CB_NOEXCEPT
+        {
+            destroy_back(n);
+            this->set_size(size() - n);
+            _tail = wrapper_t::sub(_tail, n);
+            this->record_pop(n);
+        }
+
+#if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        /// moves up to n elements from the front into dst and removes them from the
+        /// buffer, returns the number of elements read. Trivially copyable T read into
+        /// a contiguous destination are copied with at most two memcpy calls.
+        template<class OutputIt>
+        size_type read(OutputIt dst, size_type n)
+        {
+            n = (std::min)(n, size());
+            read_n(dst, n, detail::cb_is_memcpyable<OutputIt, T>());
+            pop_front(n);
+            return n;
         }
 
+#endif // !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
+
+        /// only resets the indices when T is trivially destructible, does not count as pops
         JM_CB_CXX14_CONSTEXPR void clear() JM_CB_NOEXCEPT
         {
-            while(_size != 0)
-                pop_back();
+            destroy_back(size());
+            reset_indices();
+        }
 
-            _head = 1;
-            _tail = 0;
+        /// statistics
+        /// the counters since construction or the last reset_stats(), all zero with no_stats
+        JM_CB_CONSTEXPR circular_buffer_stats stats() const JM_CB_NOEXCEPT
+        {
+            return this->get_stats();
         }
 
+        /// zeroes the counters, the peak starts again from the current size
+        JM_CB_CXX14_CONSTEXPR void reset_stats() JM_CB_NOEXCEPT { this->clear_stats(size()); }
+
         /// iterators
         JM_CB_CXX14_CONSTEXPR iterator begin() JM_CB_NOEXCEPT
         {
-            if(_size == 0)
+            if(size() == 0)
                 return end();
-            return iterator(_buffer, _head, _size);
+            return iterator(_buffer, _head, size());
         }
 
         JM_CB_CXX14_CONSTEXPR const_iterator begin() const JM_CB_NOEXCEPT
         {
-            if(_size == 0)
+            if(size() == 0)
                 return end();
-            return const_iterator(_buffer, _head, _size);
+            return const_iterator(_buffer, _head, size());
         }
 
         JM_CB_CXX14_CONSTEXPR const_iterator cbegin() const JM_CB_NOEXCEPT
         {
-            if(_size == 0)
+            if(size() == 0)
                 return cend();
-            return const_iterator(_buffer, _head, _size);
+            return const_iterator(_buffer, _head, size());
         }
 
         JM_CB_CXX14_CONSTEXPR reverse_iterator rbegin() JM_CB_NOEXCEPT
         {
-            if(_size == 0)
-                return rend();
-            return reverse_iterator(iterator(_buffer, _head, _size));
+            return reverse_iterator(end());
         }
 
         JM_CB_CXX14_CONSTEXPR const_reverse_iterator rbegin() const JM_CB_NOEXCEPT
         {
-            if(_size == 0)
-                return rend();
-            return const_reverse_iterator(const_iterator(_buffer, _head, _size));
+            return const_reverse_iterator(end());
         }
 
         JM_CB_CXX14_CONSTEXPR const_reverse_iterator crbegin() const JM_CB_NOEXCEPT
         {
-            if(_size == 0)
-                return crend();
-            return const_reverse_iterator(const_iterator(_buffer, _head, _size));
+            return const_reverse_iterator(cend());
         }
 
         JM_CB_CXX14_CONSTEXPR iterator end() JM_CB_NOEXCEPT
@@ -671,19 +1805,17 @@ namespace jm {
 
         JM_CB_CXX14_CONSTEXPR reverse_iterator rend() JM_CB_NOEXCEPT
         {
-            return reverse_iterator(iterator(_buffer, wrapper_t::increment(_tail), 0));
+            return reverse_iterator(begin());
         }
 
         JM_CB_CXX14_CONSTEXPR const_reverse_iterator rend() const JM_CB_NOEXCEPT
         {
-            return const_reverse_iterator(
-                const_iterator(_buffer, wrapper_t::increment(_tail), 0));
+            return const_reverse_iterator(begin());
         }
 
         JM_CB_CXX14_CONSTEXPR const_reverse_iterator crend() const JM_CB_NOEXCEPT
         {
-            return const_reverse_iterator(
-                const_iterator(_buffer, wrapper_t::increment(_tail), 0));
+            return const_reverse_iterator(cbegin());
         }
     };
 
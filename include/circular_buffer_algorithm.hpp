@@ -0,0 +1,186 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_CIRCULAR_BUFFER_ALGORITHM_HPP
+#define JM_CIRCULAR_BUFFER_ALGORITHM_HPP
+
+#include "circular_buffer.hpp"
+
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+namespace jm {
+
+    namespace detail {
+
+        // whether Buffer has the array_one() and array_two() segment views. The
+        // algorithms below only take such buffers, cb_iterator lives in this namespace
+        // and unconstrained overloads would be found by ADL for plain iterator calls.
+        template<class Buffer, class = void>
+        struct cb_is_segmented : std::false_type {
+        };
+
+        template<class Buffer>
+        struct cb_is_segmented<Buffer,
+                               decltype(void(std::declval<const Buffer&>().array_one()),
+                                        void(std::declval<const Buffer&>().array_two()))>
+            : std::true_type {
+        };
+
+    } // namespace detail
+
+    /// algorithms over whole buffers that split the ring into array_one() and array_two()
+    /// and run plain pointer loops over each of them instead of stepping cb_iterator,
+    /// which lets the compiler vectorize them. They accept any buffer with array_one(),
+    /// array_two() and random access begin(), such as circular_buffer and
+    /// dynamic_circular_buffer.
+
+    template<class Buffer, class UnaryFunction,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    UnaryFunction for_each(Buffer& cb, UnaryFunction f)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        return std::for_each(
+            two.first, two.first + two.second, std::for_each(one.first, one.first + one.second, f));
+    }
+
+    /// copies the elements in logical order, contiguous outputs of trivially copyable
+    /// elements end up as two memmove calls
+    template<class Buffer, class OutputIt,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    OutputIt copy(const Buffer& cb, OutputIt out)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        out = std::copy(one.first, one.first + one.second, out);
+        return std::copy(two.first, two.first + two.second, out);
+    }
+
+    template<class Buffer, class OutputIt, class UnaryOperation,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    OutputIt transform(const Buffer& cb, OutputIt out, UnaryOperation op)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        out = std::transform(one.first, one.first + one.second, out, op);
+        return std::transform(two.first, two.first + two.second, out, op);
+    }
+
+    template<class Buffer, class T,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    T accumulate(const Buffer& cb, T init)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        init = std::accumulate(one.first, one.first + one.second, init);
+        return std::accumulate(two.first, two.first + two.second, init);
+    }
+
+    template<class Buffer, class T, class BinaryOperation,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    T accumulate(const Buffer& cb, T init, BinaryOperation op)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        init = std::accumulate(one.first, one.first + one.second, init, op);
+        return std::accumulate(two.first, two.first + two.second, init, op);
+    }
+
+    /// returns an iterator to the first match or cb.end()
+    template<class Buffer, class UnaryPredicate,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    auto find_if(Buffer& cb, UnaryPredicate p) -> decltype(cb.begin())
+    {
+        const auto one = cb.array_one();
+        const auto it  = std::find_if(one.first, one.first + one.second, p);
+        if(it != one.first + one.second)
+            return cb.begin() + (it - one.first);
+
+        const auto two   = cb.array_two();
+        const auto found = std::find_if(two.first, two.first + two.second, p);
+        return cb.begin() + (one.second + (found - two.first));
+    }
+
+    template<class Buffer, class T,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    auto find(Buffer& cb, const T& value) -> decltype(cb.begin())
+    {
+        const auto one = cb.array_one();
+        const auto it  = std::find(one.first, one.first + one.second, value);
+        if(it != one.first + one.second)
+            return cb.begin() + (it - one.first);
+
+        const auto two   = cb.array_two();
+        const auto found = std::find(two.first, two.first + two.second, value);
+        return cb.begin() + (one.second + (found - two.first));
+    }
+
+    template<class Buffer, class UnaryPredicate,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    std::size_t count_if(const Buffer& cb, UnaryPredicate p)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        return static_cast<std::size_t>(std::count_if(one.first, one.first + one.second, p) +
+                                        std::count_if(two.first, two.first + two.second, p));
+    }
+
+    template<class Buffer, class T,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    std::size_t count(const Buffer& cb, const T& value)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        return static_cast<std::size_t>(std::count(one.first, one.first + one.second, value) +
+                                        std::count(two.first, two.first + two.second, value));
+    }
+
+    /// whether the elements equal the cb.size() elements starting at first
+    template<class Buffer, class InputIt,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    bool equal(const Buffer& cb, InputIt first)
+    {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+
+        const auto rest = std::mismatch(one.first, one.first + one.second, first);
+        if(rest.first != one.first + one.second)
+            return false;
+
+        return std::equal(two.first, two.first + two.second, rest.second);
+    }
+
+    /// whether [first, last) has the same length and elements as the buffer
+    template<class Buffer, class ForwardIt,
+             typename std::enable_if<detail::cb_is_segmented<Buffer>::value, int>::type = 0>
+    bool equal(const Buffer& cb, ForwardIt first, ForwardIt last)
+    {
+        return static_cast<std::size_t>(std::distance(first, last)) == cb.size() &&
+               jm::equal(cb, first);
+    }
+
+} // namespace jm
+
+#endif // include guard
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_CIRCULAR_BUFFER_IO_HPP
+#define JM_CIRCULAR_BUFFER_IO_HPP
+
+#include "circular_buffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstdint>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace jm {
+
+    /// file descriptor helpers for byte buffers such as circular_buffer<char, N> used as
+    /// socket or pipe buffers. The free or the queued space is handed to a single readv
+    /// or writev as two iovec entries, so the wrap around costs no extra system call and
+    /// no intermediate copy. They accept any buffer with reserve_back(), commit_back(),
+    /// peek_front() and consume_front(), such as circular_buffer and
+    /// dynamic_circular_buffer.
+    ///
+    /// Both return what readv / writev returned: the number of bytes transferred, which
+    /// may be less than requested, 0 at the end of file, or -1 with errno set, EAGAIN
+    /// included for non blocking descriptors. The buffer only changes by the bytes that
+    /// were transferred and interrupted calls are restarted.
+
+    namespace detail {
+
+        template<class Buffer>
+        struct cb_is_byte_buffer
+            : std::integral_constant<bool,
+                                     sizeof(typename Buffer::value_type) == 1 &&
+                                         JM_CB_IS_TRIVIALLY_COPYABLE(
+                                             typename Buffer::value_type)> {
+        };
+
+        template<class Range>
+        int cb_fill_iovec(iovec (&iov)[2], const Range& first, const Range& second) JM_CB_NOEXCEPT
+        {
+            iov[0].iov_base = const_cast<void*>(static_cast<const void*>(first.first));
+            iov[0].iov_len  = first.second;
+            iov[1].iov_base = const_cast<void*>(static_cast<const void*>(second.first));
+            iov[1].iov_len  = second.second;
+            return second.second != 0 ? 2 : 1;
+        }
+
+    } // namespace detail
+
+    /// reads up to max bytes from fd into the free space after back(). Returns 0 without
+    /// a system call when there is no free space, check full() to tell it from the end
+    /// of file.
+    template<class Buffer>
+    ssize_t read_from_fd(Buffer& cb, int fd, std::size_t max = SIZE_MAX)
+    {
+        JM_CB_STATIC_ASSERT(detail::cb_is_byte_buffer<Buffer>::value,
+                            "read_from_fd requires a buffer of trivially copyable bytes");
+
+        const typename Buffer::array_ranges free = cb.reserve_back(max);
+        if(free.first.second == 0)
+            return 0;
+
+        iovec     iov[2];
+        const int count = detail::cb_fill_iovec(iov, free.first, free.second);
+
+        ssize_t n;
+        do
+            n = ::readv(fd, iov, count);
+        while(n == -1 && errno == EINTR);
+
+        if(n > 0)
+            cb.commit_back(static_cast<std::size_t>(n));
+
+        return n;
+    }
+
+    /// writes up to max bytes from the front to fd and removes the written bytes.
+    /// Returns 0 without a system call when the buffer is empty.
+    template<class Buffer>
+    ssize_t write_to_fd(Buffer& cb, int fd, std::size_t max = SIZE_MAX)
+    {
+        JM_CB_STATIC_ASSERT(detail::cb_is_byte_buffer<Buffer>::value,
+                            "write_to_fd requires a buffer of trivially copyable bytes");
+
+        const Buffer& ccb = cb;
+
+        const typename Buffer::const_array_ranges queued = ccb.peek_front(max);
+        if(queued.first.second == 0)
+            return 0;
+
+        iovec     iov[2];
+        const int count = detail::cb_fill_iovec(iov, queued.first, queued.second);
+
+        ssize_t n;
+        do
+            n = ::writev(fd, iov, count);
+        while(n == -1 && errno == EINTR);
+
+        if(n > 0)
+            cb.consume_front(static_cast<std::size_t>(n));
+
+        return n;
+    }
+
+} // namespace jm
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // include guard
@@ -0,0 +1,1007 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_DYNAMIC_CIRCULAR_BUFFER_HPP
+#define JM_DYNAMIC_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#include <cstddef>
+
+namespace jm {
+
+    /// circular_buffer with a capacity chosen at runtime. The elements live in a single
+    /// block obtained from Allocator, which is rebound to the element storage type, so
+    /// std::pmr::polymorphic_allocator and other stateful allocators are supported.
+    /// The interface and iterators behave exactly like circular_buffer<T, N> with N
+    /// replaced by capacity(). Moving is O(1) and only exchanges the storage pointer.
+    template<typename T, class Allocator = std::allocator<T>>
+    class dynamic_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef Allocator      allocator_type;
+
+        /// a contiguous run of elements as a (pointer, length) pair
+        typedef std::pair<pointer, size_type>       array_range;
+        typedef std::pair<const_pointer, size_type> const_array_range;
+
+        /// the (at most) two runs a request for several elements spans
+        typedef std::pair<array_range, array_range>             array_ranges;
+        typedef std::pair<const_array_range, const_array_range> const_array_ranges;
+
+    private:
+        typedef detail::cb_dynamic_index_wrapper<size_type> wrapper_t;
+        typedef detail::optional_storage<T>                 storage_type;
+        typedef std::allocator_traits<Allocator>            alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<storage_type> storage_allocator;
+        typedef std::allocator_traits<storage_allocator>                   storage_traits;
+
+    public:
+        typedef detail::cb_iterator<storage_type, T, wrapper_t> iterator;
+        typedef detail::cb_iterator<const storage_type, const T, wrapper_t>
+                                                      const_iterator;
+        typedef std::reverse_iterator<iterator>       reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    private:
+        JM_CB_STATIC_ASSERT(sizeof(storage_type) == sizeof(T) &&
+                                alignof(storage_type) == alignof(T),
+                            "storage must be layout compatible with an array of T");
+        JM_CB_STATIC_ASSERT(
+            (std::is_same<typename storage_traits::pointer, storage_type*>::value),
+            "dynamic_circular_buffer requires allocators with raw pointers");
+#if !defined(__cpp_aligned_new)
+        // before c++17 std::allocator ignores alignments above that of max_align_t
+        JM_CB_STATIC_ASSERT(
+            (alignof(T) <= alignof(std::max_align_t) ||
+             !std::is_same<Allocator, std::allocator<T>>::value),
+            "over-aligned T needs c++17 or an allocator that honours its alignment");
+#endif
+
+        // copy when moving may throw so that reallocation keeps the strong guarantee
+        typedef typename std::conditional<!std::is_nothrow_move_constructible<T>::value &&
+                                              std::is_copy_constructible<T>::value,
+                                          iterator,
+                                          std::move_iterator<iterator>>::type
+            relocate_iterator;
+
+        Allocator     _alloc;
+        storage_type* _buffer;
+        wrapper_t     _wrapper;
+        size_type     _head;
+        size_type     _tail;
+        size_type     _size;
+
+        T* slot(size_type idx) JM_CB_NOEXCEPT { return JM_CB_ADDRESSOF(_buffer[idx]._value); }
+
+        const T* slot(size_type idx) const JM_CB_NOEXCEPT
+        {
+            return JM_CB_ADDRESSOF(_buffer[idx]._value);
+        }
+
+        size_type head_index() const JM_CB_NOEXCEPT { return _wrapper.index(_head); }
+
+        size_type free_index() const JM_CB_NOEXCEPT
+        {
+            return _wrapper.index(_wrapper.increment(_tail));
+        }
+
+        size_type array_one_size() const JM_CB_NOEXCEPT
+        {
+            return (std::min)(size(), capacity() - head_index());
+        }
+
+        size_type free_array_one_size() const JM_CB_NOEXCEPT
+        {
+            return (std::min)(capacity() - size(), capacity() - free_index());
+        }
+
+        storage_type* allocate(size_type n)
+        {
+            if(n == 0)
+                return JM_CB_NULLPTR;
+
+            storage_allocator alloc(_alloc);
+            return storage_traits::allocate(alloc, n);
+        }
+
+        void deallocate(storage_type* buffer, size_type n) JM_CB_NOEXCEPT
+        {
+            if(buffer == JM_CB_NULLPTR)
+                return;
+
+            storage_allocator alloc(_alloc);
+            storage_traits::deallocate(alloc, buffer, n);
+        }
+
+        template<typename... Args>
+        void construct(T* ptr, Args&&... args)
+        {
+            alloc_traits::construct(_alloc, ptr, std::forward<Args>(args)...);
+        }
+
+        void destroy(size_type pos) JM_CB_NOEXCEPT
+        {
+            alloc_traits::destroy(_alloc, slot(_wrapper.index(pos)));
+        }
+
+        void reset_indices() JM_CB_NOEXCEPT
+        {
+            _size = 0;
+            _head = 0;
+            _tail = _wrapper.decrement(0);
+        }
+
+        // frees the storage, leaving an empty buffer with no capacity
+        void release() JM_CB_NOEXCEPT
+        {
+            clear();
+            deallocate(_buffer, capacity());
+            _buffer  = JM_CB_NULLPTR;
+            _wrapper = wrapper_t(0);
+            reset_indices();
+        }
+
+        void steal(dynamic_circular_buffer& other) JM_CB_NOEXCEPT
+        {
+            _buffer  = other._buffer;
+            _wrapper = other._wrapper;
+            _head    = other._head;
+            _tail    = other._tail;
+            _size    = other._size;
+
+            other._buffer  = JM_CB_NULLPTR;
+            other._wrapper = wrapper_t(0);
+            other.reset_indices();
+        }
+
+        // allocators are only assigned when the propagation traits ask for it because
+        // some of them, like std::pmr::polymorphic_allocator, are not assignable
+        void copy_allocator(const dynamic_circular_buffer& other, std::true_type)
+        {
+            _alloc = other._alloc;
+        }
+
+        void copy_allocator(const dynamic_circular_buffer&, std::false_type) JM_CB_NOEXCEPT {}
+
+        void move_allocator(dynamic_circular_buffer& other, std::true_type) JM_CB_NOEXCEPT
+        {
+            _alloc = std::move(other._alloc);
+        }
+
+        void move_allocator(dynamic_circular_buffer&, std::false_type) JM_CB_NOEXCEPT {}
+
+        void swap_allocator(dynamic_circular_buffer& other, std::true_type) JM_CB_NOEXCEPT
+        {
+            using std::swap;
+            swap(_alloc, other._alloc);
+        }
+
+        void swap_allocator(dynamic_circular_buffer&, std::false_type) JM_CB_NOEXCEPT {}
+
+        // copies n <= capacity() elements to the slots starting at logical position pos
+        // with at most two memcpy calls
+        void copy_in(size_type pos, const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            if(n == 0)
+                return;
+
+            const size_type idx   = _wrapper.index(pos);
+            const size_type first = (std::min)(n, capacity() - idx);
+
+            std::memcpy(slot(idx), src, first * sizeof(T));
+            if(first != n)
+                std::memcpy(slot(0), src + first, (n - first) * sizeof(T));
+        }
+
+        // the mirror of copy_in, copies n <= size() elements starting at logical position pos
+        void copy_out(size_type pos, T* dst, size_type n) const JM_CB_NOEXCEPT
+        {
+            if(n == 0)
+                return;
+
+            const size_type idx   = _wrapper.index(pos);
+            const size_type first = (std::min)(n, capacity() - idx);
+
+            std::memcpy(dst, slot(idx), first * sizeof(T));
+            if(first != n)
+                std::memcpy(dst + first, slot(0), (n - first) * sizeof(T));
+        }
+
+        // constructs n elements read from first at the start of dst, destroying the ones
+        // already constructed if a constructor throws
+        template<class It>
+        void uninitialized_copy_n(It first, size_type n, storage_type* dst)
+        {
+            size_type i = 0;
+            try {
+                for(; i < n; ++i, ++first)
+                    construct(JM_CB_ADDRESSOF(dst[i]._value), *first);
+            } catch(...) {
+                while(i != 0)
+                    alloc_traits::destroy(_alloc, JM_CB_ADDRESSOF(dst[--i]._value));
+                throw;
+            }
+        }
+
+        typedef std::integral_constant<bool, JM_CB_IS_TRIVIALLY_COPYABLE(T)> memcpyable;
+
+        // copies n elements of other, starting at its logical position skip, to the
+        // start of dst
+        static void copy_elements(const dynamic_circular_buffer& other,
+                                  size_type                      skip,
+                                  size_type                      n,
+                                  storage_type*                  dst,
+                                  std::true_type) JM_CB_NOEXCEPT
+        {
+            if(n != 0)
+                other.copy_out(other._wrapper.add(other._head, skip),
+                               JM_CB_ADDRESSOF(dst->_value),
+                               n);
+        }
+
+        void copy_elements(const dynamic_circular_buffer& other,
+                           size_type                      skip,
+                           size_type                      n,
+                           storage_type*                  dst,
+                           std::false_type)
+        {
+            uninitialized_copy_n(other.begin() + skip, n, dst);
+        }
+
+        void move_elements(size_type skip, size_type n, storage_type* dst, std::true_type)
+            JM_CB_NOEXCEPT
+        {
+            copy_elements(*this, skip, n, dst, std::true_type());
+        }
+
+        void move_elements(size_type skip, size_type n, storage_type* dst, std::false_type)
+        {
+            uninitialized_copy_n(relocate_iterator(begin() + skip), n, dst);
+        }
+
+        // places the elements of other at the start of the storage, the buffer must be
+        // empty and have room for them
+        void copy_buffer(const dynamic_circular_buffer& other)
+        {
+            const size_type n = other.size();
+            copy_elements(other, 0, n, _buffer, memcpyable());
+
+            _head = 0;
+            _tail = _wrapper.decrement(n);
+            _size = n;
+        }
+
+        template<class ContiguousIt>
+        void read_n(ContiguousIt dst, size_type n, std::true_type) const JM_CB_NOEXCEPT
+        {
+            copy_out(_head, detail::cb_to_address(dst), n);
+        }
+
+        template<class OutputIt>
+        void read_n(OutputIt dst, size_type n, std::false_type)
+        {
+            const size_type first = (std::min)(n, array_one_size());
+            T*              one   = data() + head_index();
+
+            dst = std::move(one, one + first, dst);
+            std::move(data(), data() + (n - first), dst);
+        }
+
+        void push_back_n(const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            if(n >= capacity()) {
+                src += n - capacity();
+                n = capacity();
+                reset_indices();
+            }
+
+            if(JM_CB_UNLIKELY(n == 0))
+                return;
+
+            const size_type old_size = size();
+            const size_type overflow =
+                old_size + n > capacity() ? old_size + n - capacity() : 0;
+
+            copy_in(_wrapper.increment(_tail), src, n);
+            _tail = _wrapper.add(_tail, n);
+            _head = _wrapper.add(_head, overflow);
+            _size = old_size + n - overflow;
+        }
+
+        void push_front_n(const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            if(n >= capacity()) {
+                n = capacity();
+                reset_indices();
+            }
+
+            if(JM_CB_UNLIKELY(n == 0))
+                return;
+
+            const size_type old_size = size();
+            const size_type overflow =
+                old_size + n > capacity() ? old_size + n - capacity() : 0;
+            const size_type new_head = _wrapper.sub(_head, n);
+
+            copy_in(new_head, src, n);
+            _head = new_head;
+            _tail = _wrapper.sub(_tail, overflow);
+            _size = old_size + n - overflow;
+        }
+
+        template<class InputIt>
+        void push_back_range(InputIt first, InputIt last, std::input_iterator_tag, std::false_type)
+        {
+            for(; first != last; ++first)
+                push_back(*first);
+        }
+
+        template<class ForwardIt>
+        void
+        push_back_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag, std::false_type)
+        {
+            const size_type n = static_cast<size_type>(std::distance(first, last));
+            if(n > capacity())
+                std::advance(first, n - capacity());
+
+            for(; first != last; ++first)
+                push_back(*first);
+        }
+
+        template<class ContiguousIt>
+        void push_back_range(ContiguousIt first,
+                             ContiguousIt last,
+                             std::random_access_iterator_tag,
+                             std::true_type) JM_CB_NOEXCEPT
+        {
+            push_back_n(detail::cb_to_address(first), static_cast<size_type>(last - first));
+        }
+
+        template<class BidirIt>
+        void push_front_range(BidirIt first, BidirIt last, std::false_type)
+        {
+            const size_type n = static_cast<size_type>(std::distance(first, last));
+            if(n > capacity()) {
+                last = first;
+                std::advance(last, capacity());
+            }
+
+            while(last != first)
+                push_front(*--last);
+        }
+
+        template<class ContiguousIt>
+        void push_front_range(ContiguousIt first, ContiguousIt last, std::true_type) JM_CB_NOEXCEPT
+        {
+            push_front_n(detail::cb_to_address(first), static_cast<size_type>(last - first));
+        }
+
+    public:
+        dynamic_circular_buffer() : dynamic_circular_buffer(Allocator()) {}
+
+        explicit dynamic_circular_buffer(const Allocator& alloc)
+            : _alloc(alloc)
+            , _buffer(JM_CB_NULLPTR)
+            , _wrapper(0)
+            , _head(0)
+            , _tail(_wrapper.decrement(0))
+            , _size(0)
+        {}
+
+        explicit dynamic_circular_buffer(size_type capacity, const Allocator& alloc = Allocator())
+            : _alloc(alloc)
+            , _buffer(allocate(capacity))
+            , _wrapper(capacity)
+            , _head(0)
+            , _tail(_wrapper.decrement(0))
+            , _size(0)
+        {}
+
+        dynamic_circular_buffer(size_type        capacity,
+                                size_type        count,
+                                const T&         value,
+                                const Allocator& alloc = Allocator())
+            : dynamic_circular_buffer(capacity, alloc)
+        {
+            if(JM_CB_UNLIKELY(count > capacity))
+                throw std::out_of_range("dynamic_circular_buffer<T>(size_type capacity, size_type "
+                                        "count, const T&) count exceeded capacity");
+
+            for(; count != 0; --count)
+                push_back(value);
+        }
+
+        /// the capacity is the number of elements in init
+        dynamic_circular_buffer(std::initializer_list<T> init,
+                                const Allocator&         alloc = Allocator())
+            : dynamic_circular_buffer(init.size(), alloc)
+        {
+            push_back(init.begin(), init.end());
+        }
+
+        dynamic_circular_buffer(const dynamic_circular_buffer& other)
+            : dynamic_circular_buffer(
+                  other.capacity(),
+                  alloc_traits::select_on_container_copy_construction(other._alloc))
+        {
+            copy_buffer(other);
+        }
+
+        dynamic_circular_buffer(dynamic_circular_buffer&& other) JM_CB_NOEXCEPT
+            : _alloc(std::move(other._alloc))
+            , _buffer(JM_CB_NULLPTR)
+            , _wrapper(0)
+            , _head(0)
+            , _tail(0)
+            , _size(0)
+        {
+            steal(other);
+        }
+
+        dynamic_circular_buffer& operator=(const dynamic_circular_buffer& other)
+        {
+            if(this == JM_CB_ADDRESSOF(other))
+                return *this;
+
+            clear();
+            if(alloc_traits::propagate_on_container_copy_assignment::value &&
+               _alloc != other._alloc) {
+                release();
+                copy_allocator(other,
+                               typename alloc_traits::propagate_on_container_copy_assignment());
+            }
+
+            if(capacity() != other.capacity()) {
+                release();
+                _buffer  = allocate(other.capacity());
+                _wrapper = wrapper_t(other.capacity());
+                reset_indices();
+            }
+
+            copy_buffer(other);
+            return *this;
+        }
+
+        /// takes the storage of other unless the allocators differ and do not propagate,
+        /// in which case the elements are moved one by one
+        dynamic_circular_buffer& operator=(dynamic_circular_buffer&& other)
+        {
+            if(this == JM_CB_ADDRESSOF(other))
+                return *this;
+
+            if(alloc_traits::propagate_on_container_move_assignment::value ||
+               _alloc == other._alloc) {
+                release();
+                move_allocator(other,
+                               typename alloc_traits::propagate_on_container_move_assignment());
+                steal(other);
+            }
+            else {
+                if(capacity() != other.capacity()) {
+                    release();
+                    _buffer  = allocate(other.capacity());
+                    _wrapper = wrapper_t(other.capacity());
+                    reset_indices();
+                }
+                else
+                    clear();
+
+                for(iterator first = other.begin(), last = other.end(); first != last; ++first)
+                    emplace_back(std::move(*first));
+                other.clear();
+            }
+
+            return *this;
+        }
+
+        ~dynamic_circular_buffer() { release(); }
+
+        void swap(dynamic_circular_buffer& other) JM_CB_NOEXCEPT
+        {
+            using std::swap;
+            swap_allocator(other, typename alloc_traits::propagate_on_container_swap());
+            swap(_buffer, other._buffer);
+            swap(_wrapper, other._wrapper);
+            swap(_head, other._head);
+            swap(_tail, other._tail);
+            swap(_size, other._size);
+        }
+
+        friend void swap(dynamic_circular_buffer& lhs, dynamic_circular_buffer& rhs) JM_CB_NOEXCEPT
+        {
+            lhs.swap(rhs);
+        }
+
+        allocator_type get_allocator() const { return _alloc; }
+
+        /// capacity
+        bool empty() const JM_CB_NOEXCEPT { return size() == 0; }
+
+        bool full() const JM_CB_NOEXCEPT { return size() == capacity(); }
+
+        size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+        size_type capacity() const JM_CB_NOEXCEPT { return _wrapper.capacity(); }
+
+        /// the same as capacity(), the buffer never holds more elements than that
+        size_type max_size() const JM_CB_NOEXCEPT { return capacity(); }
+
+        /// reallocates the storage for new_capacity elements, keeping the newest
+        /// min(size(), new_capacity) elements. The elements are moved over in logical order
+        /// in a single pass, so afterwards they occupy one contiguous run starting at
+        /// data(). If an element constructor throws the buffer is left unchanged.
+        void set_capacity(size_type new_capacity)
+        {
+            if(new_capacity == capacity())
+                return;
+
+            const size_type n      = (std::min)(size(), new_capacity);
+            storage_type*   buffer = allocate(new_capacity);
+
+            try {
+                move_elements(size() - n, n, buffer, memcpyable());
+            } catch(...) {
+                deallocate(buffer, new_capacity);
+                throw;
+            }
+
+            release();
+            _buffer  = buffer;
+            _wrapper = wrapper_t(new_capacity);
+            _tail    = _wrapper.decrement(n);
+            _size    = n;
+        }
+
+        /// grows the capacity to at least new_capacity
+        void reserve(size_type new_capacity)
+        {
+            if(new_capacity > capacity())
+                set_capacity(new_capacity);
+        }
+
+        /// shrinks the capacity to size()
+        void shrink_to_fit() { set_capacity(size()); }
+
+        /// element access
+        reference front() JM_CB_NOEXCEPT { return *slot(_wrapper.index(_head)); }
+
+        const_reference front() const JM_CB_NOEXCEPT { return *slot(_wrapper.index(_head)); }
+
+        reference operator[](size_type pos) JM_CB_NOEXCEPT
+        {
+            return *slot(_wrapper.index(_wrapper.add(_head, pos)));
+        }
+
+        const_reference operator[](size_type pos) const JM_CB_NOEXCEPT
+        {
+            return *slot(_wrapper.index(_wrapper.add(_head, pos)));
+        }
+
+        reference at(size_type pos)
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range(
+                    "dynamic_circular_buffer<T>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range(
+                    "dynamic_circular_buffer<T>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
+        }
+
+        reference back() JM_CB_NOEXCEPT { return *slot(_wrapper.index(_tail)); }
+
+        const_reference back() const JM_CB_NOEXCEPT { return *slot(_wrapper.index(_tail)); }
+
+        /// the start of the storage, nullptr while capacity() == 0
+        pointer data() JM_CB_NOEXCEPT { return _buffer ? slot(0) : JM_CB_NULLPTR; }
+
+        const_pointer data() const JM_CB_NOEXCEPT { return _buffer ? slot(0) : JM_CB_NULLPTR; }
+
+        /// the elements in logical order as at most two contiguous runs,
+        /// array_two is empty unless the elements wrap around the end of the storage
+        array_range array_one() JM_CB_NOEXCEPT
+        {
+            return array_range(data() + head_index(), array_one_size());
+        }
+
+        const_array_range array_one() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(data() + head_index(), array_one_size());
+        }
+
+        array_range array_two() JM_CB_NOEXCEPT
+        {
+            return array_range(data(), size() - array_one_size());
+        }
+
+        const_array_range array_two() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(data(), size() - array_one_size());
+        }
+
+        /// the uninitialized storage after back() as at most two contiguous runs
+        array_range free_array_one() JM_CB_NOEXCEPT
+        {
+            return array_range(data() + free_index(), free_array_one_size());
+        }
+
+        array_range free_array_two() JM_CB_NOEXCEPT
+        {
+            return array_range(data(), capacity() - size() - free_array_one_size());
+        }
+
+        /// in place producer and consumer access
+        /// up to n uninitialized slots after back() as at most two contiguous runs, fewer
+        /// when there is less free space. Elements constructed there in order, starting
+        /// with the first run, become part of the buffer with commit_back().
+        array_ranges reserve_back(size_type n) JM_CB_NOEXCEPT
+        {
+            n = (std::min)(n, capacity() - size());
+            if(n == 0)
+                return array_ranges(array_range(data(), 0), array_range(data(), 0));
+
+            const size_type first = (std::min)(n, free_array_one_size());
+            return array_ranges(array_range(data() + free_index(), first),
+                                array_range(data(), n - first));
+        }
+
+        /// appends the first n elements constructed in the slots returned by the last
+        /// reserve_back(), n must not exceed the number of slots it returned
+        void commit_back(size_type n) JM_CB_NOEXCEPT
+        {
+            _tail = _wrapper.add(_tail, n);
+            _size += n;
+        }
+
+        /// the first min(n, size()) elements as at most two contiguous runs
+        array_ranges peek_front(size_type n) JM_CB_NOEXCEPT
+        {
+            n                     = (std::min)(n, size());
+            const size_type first = (std::min)(n, array_one_size());
+            return array_ranges(array_range(data() + head_index(), first),
+                                array_range(data(), n - first));
+        }
+
+        const_array_ranges peek_front(size_type n) const JM_CB_NOEXCEPT
+        {
+            n                     = (std::min)(n, size());
+            const size_type first = (std::min)(n, array_one_size());
+            return const_array_ranges(const_array_range(data() + head_index(), first),
+                                      const_array_range(data(), n - first));
+        }
+
+        /// removes the first n elements once they have been processed through peek_front(),
+        /// n must not exceed size()
+        void consume_front(size_type n) JM_CB_NOEXCEPT { pop_front(n); }
+
+        /// modifiers, pushing into a buffer without capacity does nothing
+        void push_back(const value_type& value)
+        {
+            const size_type new_tail = _wrapper.increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _head                           = _wrapper.increment(_head);
+                *slot(_wrapper.index(new_tail)) = value;
+            }
+            else {
+                construct(slot(_wrapper.index(new_tail)), value);
+                ++_size;
+            }
+
+            _tail = new_tail;
+        }
+
+        void push_front(const value_type& value)
+        {
+            const size_type new_head = _wrapper.decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _tail                           = _wrapper.decrement(_tail);
+                *slot(_wrapper.index(new_head)) = value;
+            }
+            else {
+                construct(slot(_wrapper.index(new_head)), value);
+                ++_size;
+            }
+
+            _head = new_head;
+        }
+
+        /// appends value unless the buffer is full, in which case nothing is
+        /// constructed, the contents are left untouched and false is returned
+        bool try_push_back(const value_type& value) { return try_emplace_back(value); }
+
+        /// prepends value unless the buffer is full
+        bool try_push_front(const value_type& value) { return try_emplace_front(value); }
+
+        bool try_push_back(value_type&& value) { return try_emplace_back(std::move(value)); }
+
+        bool try_push_front(value_type&& value) { return try_emplace_front(std::move(value)); }
+
+        void push_back(value_type&& value)
+        {
+            const size_type new_tail = _wrapper.increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _head                           = _wrapper.increment(_head);
+                *slot(_wrapper.index(new_tail)) = detail::move_if_noexcept_assign(value);
+            }
+            else {
+                construct(slot(_wrapper.index(new_tail)), std::move_if_noexcept(value));
+                ++_size;
+            }
+
+            _tail = new_tail;
+        }
+
+        void push_front(value_type&& value)
+        {
+            const size_type new_head = _wrapper.decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _tail                           = _wrapper.decrement(_tail);
+                *slot(_wrapper.index(new_head)) = detail::move_if_noexcept_assign(value);
+            }
+            else {
+                construct(slot(_wrapper.index(new_head)), std::move_if_noexcept(value));
+                ++_size;
+            }
+
+            _head = new_head;
+        }
+
+        /// appends [first, last) as if by push_back of every element, only the last
+        /// capacity() elements of a longer range are written
+        template<typename InputIt,
+                 typename std::enable_if<!std::is_integral<InputIt>::value, int>::type = 0>
+        void push_back(InputIt first, InputIt last)
+        {
+            push_back_range(first,
+                            last,
+                            typename std::iterator_traits<InputIt>::iterator_category(),
+                            detail::cb_is_memcpyable<InputIt, T>());
+        }
+
+        /// prepends [first, last) keeping its order so that front() == *first,
+        /// only the first capacity() elements of a longer range are written
+        template<typename BidirIt,
+                 typename std::enable_if<!std::is_integral<BidirIt>::value, int>::type = 0>
+        void push_front(BidirIt first, BidirIt last)
+        {
+            push_front_range(first, last, detail::cb_is_memcpyable<BidirIt, T>());
+        }
+
+        /// replaces the contents with [first, last), keeping the last capacity() elements
+        template<typename InputIt,
+                 typename std::enable_if<!std::is_integral<InputIt>::value, int>::type = 0>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            push_back(first, last);
+        }
+
+        /// replaces the contents with min(count, capacity()) copies of value
+        void assign(size_type count, const T& value)
+        {
+            clear();
+            for(count = (std::min)(count, capacity()); count != 0; --count)
+                push_back(value);
+        }
+
+        void assign(std::initializer_list<T> init)
+        {
+            clear();
+            push_back(init.begin(), init.end());
+        }
+
+        template<typename... Args>
+        void emplace_back(Args&&... args)
+        {
+            const size_type new_tail = _wrapper.increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _head = _wrapper.increment(_head);
+                destroy(new_tail);
+            }
+            else
+                ++_size;
+
+            construct(slot(_wrapper.index(new_tail)), std::forward<Args>(args)...);
+            _tail = new_tail;
+        }
+
+        template<typename... Args>
+        void emplace_front(Args&&... args)
+        {
+            const size_type new_head = _wrapper.decrement(_head);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                if(JM_CB_UNLIKELY(capacity() == 0))
+                    return;
+
+                _tail = _wrapper.decrement(_tail);
+                destroy(new_head);
+            }
+            else
+                ++_size;
+
+            construct(slot(_wrapper.index(new_head)), std::forward<Args>(args)...);
+            _head = new_head;
+        }
+
+        /// constructs the element in place unless the buffer is full, the arguments are
+        /// not touched when false is returned
+        template<typename... Args>
+        bool try_emplace_back(Args&&... args)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_tail = _wrapper.increment(_tail);
+            construct(slot(_wrapper.index(new_tail)), std::forward<Args>(args)...);
+            ++_size;
+            _tail = new_tail;
+            return true;
+        }
+
+        template<typename... Args>
+        bool try_emplace_front(Args&&... args)
+        {
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                return false;
+
+            const size_type new_head = _wrapper.decrement(_head);
+            construct(slot(_wrapper.index(new_head)), std::forward<Args>(args)...);
+            ++_size;
+            _head = new_head;
+            return true;
+        }
+
+        void pop_back() JM_CB_NOEXCEPT
+        {
+            size_type old_tail = _tail;
+            --_size;
+            _tail = _wrapper.decrement(_tail);
+            destroy(old_tail);
+        }
+
+        void pop_front() JM_CB_NOEXCEPT
+        {
+            size_type old_head = _head;
+            --_size;
+            _head = _wrapper.increment(_head);
+            destroy(old_head);
+        }
+
+        /// removes the first n elements, n must not exceed size()
+        void pop_front(size_type n) JM_CB_NOEXCEPT
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T))
+                for(size_type i = 0, pos = _head; i < n; ++i, pos = _wrapper.increment(pos))
+                    destroy(pos);
+
+            _size -= n;
+            _head = _wrapper.add(_head, n);
+        }
+
+        /// removes the last n elements, n must not exceed size()
+        void pop_back(size_type n) JM_CB_NOEXCEPT
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T))
+                for(size_type i = 0, pos = _tail; i < n; ++i, pos = _wrapper.decrement(pos))
+                    destroy(pos);
+
+            _size -= n;
+            _tail = _wrapper.sub(_tail, n);
+        }
+
+        /// moves up to n elements from the front into dst and removes them from the
+        /// buffer, returns the number of elements read
+        template<class OutputIt>
+        size_type read(OutputIt dst, size_type n)
+        {
+            n = (std::min)(n, size());
+            read_n(dst, n, detail::cb_is_memcpyable<OutputIt, T>());
+            pop_front(n);
+            return n;
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            pop_back(size());
+            reset_indices();
+        }
+
+        /// iterators
+        iterator begin() JM_CB_NOEXCEPT
+        {
+            if(size() == 0)
+                return end();
+            return iterator(_buffer, _head, size(), _wrapper);
+        }
+
+        const_iterator begin() const JM_CB_NOEXCEPT
+        {
+            if(size() == 0)
+                return end();
+            return const_iterator(_buffer, _head, size(), _wrapper);
+        }
+
+        const_iterator cbegin() const JM_CB_NOEXCEPT { return begin(); }
+
+        reverse_iterator rbegin() JM_CB_NOEXCEPT { return reverse_iterator(end()); }
+
+        const_reverse_iterator rbegin() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator crbegin() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(cend());
+        }
+
+        iterator end() JM_CB_NOEXCEPT
+        {
+            return iterator(_buffer, _wrapper.increment(_tail), 0, _wrapper);
+        }
+
+        const_iterator end() const JM_CB_NOEXCEPT
+        {
+            return const_iterator(_buffer, _wrapper.increment(_tail), 0, _wrapper);
+        }
+
+        const_iterator cend() const JM_CB_NOEXCEPT { return end(); }
+
+        reverse_iterator rend() JM_CB_NOEXCEPT { return reverse_iterator(begin()); }
+
+        const_reverse_iterator rend() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crend() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(cbegin());
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_MIRRORED_CIRCULAR_BUFFER_HPP
+#define JM_MIRRORED_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace jm {
+
+    namespace detail {
+
+        inline std::size_t cb_gcd(std::size_t a, std::size_t b) JM_CB_NOEXCEPT
+        {
+            while(b != 0) {
+                const std::size_t r = a % b;
+                a                   = b;
+                b                   = r;
+            }
+
+            return a;
+        }
+
+        // maps the same memfd pages twice back to back and returns the start of the
+        // first view, bytes must be a multiple of the page size
+        inline unsigned char* cb_map_mirrored(std::size_t bytes)
+        {
+            const int fd = ::memfd_create("jm_mirrored_circular_buffer", MFD_CLOEXEC);
+            if(fd == -1)
+                throw std::system_error(errno, std::generic_category(), "memfd_create");
+
+            if(::ftruncate(fd, static_cast<off_t>(bytes)) == -1) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "ftruncate");
+            }
+
+            // reserve the address range for both views first so that nothing else can
+            // end up between them
+            void* base =
+                ::mmap(JM_CB_NULLPTR, bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(base == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+
+            unsigned char* first = static_cast<unsigned char*>(base);
+            for(int view = 0; view < 2; ++view) {
+                if(::mmap(first + view * bytes,
+                          bytes,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED,
+                          fd,
+                          0) == MAP_FAILED) {
+                    const int error = errno;
+                    ::munmap(base, bytes * 2);
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "mmap");
+                }
+            }
+
+            // the mappings keep the memory alive
+            ::close(fd);
+            return first;
+        }
+
+    } // namespace detail
+
+    /// ring of trivially copyable elements whose storage is mapped twice back to back,
+    /// so that any window of up to capacity() elements starting anywhere in the ring is
+    /// a single contiguous span. Readers get the queued elements from data_from_head()
+    /// and writers get the free space from data_from_tail() without ever having to
+    /// handle the wrap around. Linux only, the mirror is built from a memfd.
+    template<typename T>
+    class mirrored_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+    private:
+        JM_CB_STATIC_ASSERT(JM_CB_IS_TRIVIALLY_COPYABLE(T),
+                            "mirrored_circular_buffer requires a trivially copyable T");
+
+        T*        _data;
+        size_type _capacity;
+        size_type _head;
+        size_type _size;
+
+        // the smallest byte size holding min_capacity elements that is a multiple of both
+        // the page size and sizeof(T)
+        static size_type mapping_size(size_type min_capacity)
+        {
+            const size_type page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+            const size_type unit = page / detail::cb_gcd(page, sizeof(T)) * sizeof(T);
+            const size_type min_bytes =
+                (std::max)(min_capacity, static_cast<size_type>(1)) * sizeof(T);
+
+            return (min_bytes + unit - 1) / unit * unit;
+        }
+
+        size_type tail_index() const JM_CB_NOEXCEPT
+        {
+            const size_type tail = _head + _size;
+            return tail >= _capacity ? tail - _capacity : tail;
+        }
+
+    public:
+        /// maps room for at least min_capacity elements, the capacity is rounded up so
+        /// that the storage is a whole number of pages. Throws std::system_error when the
+        /// mapping cannot be created.
+        explicit mirrored_circular_buffer(size_type min_capacity)
+            : _data(JM_CB_NULLPTR), _capacity(0), _head(0), _size(0)
+        {
+            const size_type bytes = mapping_size(min_capacity);
+            _data                 = reinterpret_cast<T*>(detail::cb_map_mirrored(bytes));
+            _capacity             = bytes / sizeof(T);
+        }
+
+        mirrored_circular_buffer(const mirrored_circular_buffer&) = delete;
+        mirrored_circular_buffer& operator=(const mirrored_circular_buffer&) = delete;
+
+        mirrored_circular_buffer(mirrored_circular_buffer&& other) JM_CB_NOEXCEPT
+            : _data(other._data)
+            , _capacity(other._capacity)
+            , _head(other._head)
+            , _size(other._size)
+        {
+            other._data     = JM_CB_NULLPTR;
+            other._capacity = 0;
+            other._head     = 0;
+            other._size     = 0;
+        }
+
+        mirrored_circular_buffer& operator=(mirrored_circular_buffer&& other) JM_CB_NOEXCEPT
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~mirrored_circular_buffer()
+        {
+            if(_data != JM_CB_NULLPTR)
+                ::munmap(_data, _capacity * sizeof(T) * 2);
+        }
+
+        void swap(mirrored_circular_buffer& other) JM_CB_NOEXCEPT
+        {
+            std::swap(_data, other._data);
+            std::swap(_capacity, other._capacity);
+            std::swap(_head, other._head);
+            std::swap(_size, other._size);
+        }
+
+        friend void swap(mirrored_circular_buffer& lhs, mirrored_circular_buffer& rhs)
+            JM_CB_NOEXCEPT
+        {
+            lhs.swap(rhs);
+        }
+
+        /// capacity
+        bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
+
+        bool full() const JM_CB_NOEXCEPT { return _size == _capacity; }
+
+        size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+        size_type capacity() const JM_CB_NOEXCEPT { return _capacity; }
+
+        size_type max_size() const JM_CB_NOEXCEPT { return _capacity; }
+
+        /// element access
+        reference front() JM_CB_NOEXCEPT { return _data[_head]; }
+
+        const_reference front() const JM_CB_NOEXCEPT { return _data[_head]; }
+
+        reference back() JM_CB_NOEXCEPT { return _data[_head + _size - 1]; }
+
+        const_reference back() const JM_CB_NOEXCEPT { return _data[_head + _size - 1]; }
+
+        reference operator[](size_type pos) JM_CB_NOEXCEPT { return _data[_head + pos]; }
+
+        const_reference operator[](size_type pos) const JM_CB_NOEXCEPT
+        {
+            return _data[_head + pos];
+        }
+
+        /// the size() queued elements as one contiguous run
+        pointer data_from_head() JM_CB_NOEXCEPT { return _data + _head; }
+
+        const_pointer data_from_head() const JM_CB_NOEXCEPT { return _data + _head; }
+
+        /// the capacity() - size() free slots after back() as one contiguous run,
+        /// elements written there become part of the buffer with commit()
+        pointer data_from_tail() JM_CB_NOEXCEPT { return _data + tail_index(); }
+
+        /// appends the n elements written to data_from_tail(), n must not exceed
+        /// capacity() - size()
+        void commit(size_type n) JM_CB_NOEXCEPT { _size += n; }
+
+        /// removes the first n elements, n must not exceed size()
+        void consume(size_type n) JM_CB_NOEXCEPT
+        {
+            _head += n;
+            if(_head >= _capacity)
+                _head -= _capacity;
+            _size -= n;
+        }
+
+        /// modifiers
+        /// copies as many of the n elements at src as fit and returns their count
+        size_type write(const T* src, size_type n) JM_CB_NOEXCEPT
+        {
+            n = (std::min)(n, _capacity - _size);
+            if(n != 0)
+                std::memcpy(data_from_tail(), src, n * sizeof(T));
+            commit(n);
+            return n;
+        }
+
+        /// copies up to n elements from the front into dst, removes them and returns
+        /// their count
+        size_type read(T* dst, size_type n) JM_CB_NOEXCEPT
+        {
+            n = (std::min)(n, _size);
+            if(n != 0)
+                std::memcpy(dst, data_from_head(), n * sizeof(T));
+            consume(n);
+            return n;
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            _head = 0;
+            _size = 0;
+        }
+    };
+
+} // namespace jm
+
+#endif // defined(__linux__)
+
+#endif // include guard
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_MPMC_CIRCULAR_BUFFER_HPP
+#define JM_MPMC_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace jm {
+
+    /// lock free fixed capacity queue for any number of producer and consumer threads,
+    /// a bounded queue in the style of Dmitry Vyukov's.
+    /// Every slot carries a sequence number which tells whether it is ready to be
+    /// written (sequence == position) or read (sequence == position + 1), so producers
+    /// and consumers only contend on their own position counter and the slot itself.
+    /// N must be at least 2. If constructing an element throws, its position is still
+    /// published but marked empty so consumers skip it, and if moving a popped element
+    /// into out throws, the element is destroyed. Either way the exception propagates
+    /// and the queue keeps working.
+    template<typename T, std::size_t N>
+    class mpmc_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+    private:
+        // with a single slot a written sequence (pos + 1) reads as free for the next
+        // position, so at least two are needed
+        JM_CB_STATIC_ASSERT(N > 1, "mpmc_circular_buffer requires N > 1");
+
+        struct slot_type {
+            std::atomic<size_type>      sequence;
+            bool                        poisoned; // published without an element
+            detail::optional_storage<T> storage;
+        };
+
+        alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<size_type> _enqueue_pos;
+        alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<size_type> _dequeue_pos;
+        alignas(JM_CB_CACHE_LINE_SIZE) slot_type _slots[N];
+
+        static difference_type distance(size_type sequence, size_type pos) noexcept
+        {
+            return static_cast<difference_type>(sequence - pos);
+        }
+
+        // claims the slot for position pos as a producer, returns nullptr when full
+        slot_type* claim_enqueue(size_type& pos) noexcept
+        {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+            for(;;) {
+                slot_type&            slot = _slots[pos % N];
+                const difference_type dif =
+                    distance(slot.sequence.load(std::memory_order_acquire), pos);
+
+                if(dif == 0) {
+                    if(_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        return JM_CB_ADDRESSOF(slot);
+                }
+                else if(dif < 0)
+                    return JM_CB_NULLPTR;
+                else
+                    pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot_type* claim_dequeue(size_type& pos) noexcept
+        {
+            pos = _dequeue_pos.load(std::memory_order_relaxed);
+            for(;;) {
+                slot_type&            slot = _slots[pos % N];
+                const difference_type dif =
+                    distance(slot.sequence.load(std::memory_order_acquire), pos + 1);
+
+                if(dif == 0) {
+                    if(_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        return JM_CB_ADDRESSOF(slot);
+                }
+                else if(dif < 0)
+                    return JM_CB_NULLPTR;
+                else
+                    pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        // constructs the element of a claimed slot and publishes it. A throwing
+        // constructor still publishes the position, consumers would wait on it forever
+        // otherwise.
+        template<typename... Args>
+        void publish(slot_type* slot, size_type pos, Args&&... args)
+        {
+            try {
+                new(JM_CB_ADDRESSOF(slot->storage._value)) T(std::forward<Args>(args)...);
+            } catch(...) {
+                slot->poisoned = true;
+                slot->sequence.store(pos + 1, std::memory_order_release);
+                throw;
+            }
+
+            slot->sequence.store(pos + 1, std::memory_order_release);
+        }
+
+    public:
+        mpmc_circular_buffer() noexcept : _enqueue_pos(0), _dequeue_pos(0)
+        {
+            for(size_type i = 0; i < N; ++i) {
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+                _slots[i].poisoned = false;
+            }
+        }
+
+        mpmc_circular_buffer(const mpmc_circular_buffer&) = delete;
+        mpmc_circular_buffer& operator=(const mpmc_circular_buffer&) = delete;
+
+        ~mpmc_circular_buffer()
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)) {
+                const size_type last = _enqueue_pos.load(std::memory_order_acquire);
+                for(size_type pos = _dequeue_pos.load(std::memory_order_relaxed); pos != last;
+                    ++pos)
+                    if(!_slots[pos % N].poisoned)
+                        _slots[pos % N].storage._value.~T();
+            }
+        }
+
+        /// capacity, only approximate while other threads are running
+        bool empty() const noexcept { return size() == 0; }
+
+        size_type size() const noexcept
+        {
+            const size_type head = _dequeue_pos.load(std::memory_order_acquire);
+            const size_type tail = _enqueue_pos.load(std::memory_order_acquire);
+            return tail > head ? (std::min)(tail - head, N) : 0;
+        }
+
+        JM_CB_CONSTEXPR size_type max_size() const noexcept { return N; }
+
+        /// producers
+        template<typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            size_type  pos;
+            slot_type* slot = claim_enqueue(pos);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(slot == JM_CB_NULLPTR))
+                return false;
+
+            publish(slot, pos, std::forward<Args>(args)...);
+            return true;
+        }
+
+        bool try_push(const value_type& value) { return try_emplace(value); }
+
+        bool try_push(value_type&& value) { return try_emplace(std::move(value)); }
+
+        /// constructs the element in place, yielding until a slot becomes free
+        template<typename... Args>
+        void emplace(Args&&... args)
+        {
+            size_type  pos;
+            slot_type* slot;
+            while((slot = claim_enqueue(pos)) == JM_CB_NULLPTR)
+                std::this_thread::yield();
+
+            publish(slot, pos, std::forward<Args>(args)...);
+        }
+
+        /// consumers
+        bool try_pop(value_type& out)
+        {
+            for(;;) {
+                size_type  pos;
+                slot_type* slot = claim_dequeue(pos);
+                if(slot == JM_CB_NULLPTR)
+                    return false;
+
+                if(JM_CB_UNLIKELY(slot->poisoned)) {
+                    slot->poisoned = false;
+                    slot->sequence.store(pos + N, std::memory_order_release);
+                    continue;
+                }
+
+                T& value = slot->storage._value;
+                try {
+                    out = std::move(value);
+                } catch(...) {
+                    value.~T();
+                    slot->sequence.store(pos + N, std::memory_order_release);
+                    throw;
+                }
+
+                value.~T();
+                slot->sequence.store(pos + N, std::memory_order_release);
+                return true;
+            }
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_PERSISTENT_CIRCULAR_BUFFER_HPP
+#define JM_PERSISTENT_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jm {
+
+    /// what persistent_circular_buffer restores when it reopens a file
+    enum class persistent_recovery {
+        /// the state after the last push or pop, which every write to the mapping
+        /// survives as long as the machine keeps running, process crashes included
+        latest,
+        /// the state of the last flush(), the one that also survives a power loss,
+        /// without the oldest elements that pushes made after it have overwritten
+        flushed
+    };
+
+    namespace detail {
+
+        // the first 64 bytes of the file. A pop changes a single counter and a push into
+        // a full ring retires the oldest element before it overwrites its slot, so
+        // whatever point a crash interrupts, the live counters describe a consistent
+        // state. The checksum covers the format and the counters saved by flush().
+        struct cb_persistent_header {
+            std::uint64_t magic;
+            std::uint32_t version;
+            std::uint32_t element_size;
+            std::uint64_t capacity;
+            std::uint64_t checksum;
+            std::uint64_t flushed_pushed;
+            std::uint64_t flushed_popped;
+            std::uint64_t pushed; // elements ever pushed
+            std::uint64_t popped; // elements ever popped or overwritten
+        };
+
+        JM_CB_STATIC_ASSERT(sizeof(cb_persistent_header) == 64,
+                            "the header must keep its on disk layout");
+
+        const std::uint64_t cb_persistent_magic   = 0x4a4d5052494e4731ull; // "JMPRING1"
+        const std::uint32_t cb_persistent_version = 1;
+
+        // 64 bit FNV-1a
+        inline std::uint64_t cb_fnv1a(const void* data, std::size_t n, std::uint64_t hash)
+            JM_CB_NOEXCEPT
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for(std::size_t i = 0; i < n; ++i) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+
+            return hash;
+        }
+
+        inline std::uint64_t cb_header_checksum(const cb_persistent_header& h) JM_CB_NOEXCEPT
+        {
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            hash               = cb_fnv1a(&h.magic, sizeof(h.magic), hash);
+            hash               = cb_fnv1a(&h.version, sizeof(h.version), hash);
+            hash               = cb_fnv1a(&h.element_size, sizeof(h.element_size), hash);
+            hash               = cb_fnv1a(&h.capacity, sizeof(h.capacity), hash);
+            hash               = cb_fnv1a(&h.flushed_pushed, sizeof(h.flushed_pushed), hash);
+            return cb_fnv1a(&h.flushed_popped, sizeof(h.flushed_popped), hash);
+        }
+
+    } // namespace detail
+
+    /// fixed capacity ring of trivially copyable elements that lives in a memory mapped
+    /// file, a flight recorder that outlives the process. Pushes and pops are plain
+    /// stores into the mapping: the element first, then one counter in the file header.
+    /// flush() writes everything back with msync and saves a checksummed checkpoint.
+    /// Reopening the file restores the latest state or the last checkpoint, see
+    /// persistent_recovery.
+    template<typename T>
+    class persistent_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+        /// a contiguous run of elements as a (pointer, length) pair
+        typedef std::pair<pointer, size_type>       array_range;
+        typedef std::pair<const_pointer, size_type> const_array_range;
+
+    private:
+        JM_CB_STATIC_ASSERT(JM_CB_IS_TRIVIALLY_COPYABLE(T),
+                            "persistent_circular_buffer requires a trivially copyable T");
+
+        typedef detail::cb_persistent_header header_type;
+
+        unsigned char* _mapping;
+        size_type      _mapping_size;
+        header_type*   _header;
+        T*             _data;
+        size_type      _capacity;
+        size_type      _head; // slot of front()
+        size_type      _tail; // slot the next push writes
+        size_type      _size;
+        std::uint64_t  _pushed;
+
+        static size_type data_offset() JM_CB_NOEXCEPT
+        {
+            const size_type align = alignof(T) > 64 ? alignof(T) : 64;
+            return (sizeof(header_type) + align - 1) / align * align;
+        }
+
+        size_type wrap(size_type index) const JM_CB_NOEXCEPT
+        {
+            return index >= _capacity ? index - _capacity : index;
+        }
+
+        // makes the stores before it reach the mapping before the counter that
+        // publishes them
+        static void publish_barrier() JM_CB_NOEXCEPT
+        {
+            std::atomic_signal_fence(std::memory_order_release);
+        }
+
+        void map_file(const char* path, size_type capacity)
+        {
+            const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if(fd == -1)
+                throw std::system_error(errno, std::generic_category(), "open");
+
+            struct stat st;
+            if(::fstat(fd, &st) == -1) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "fstat");
+            }
+
+            const bool created = st.st_size == 0;
+            _mapping_size      = data_offset() + capacity * sizeof(T);
+            if(!created && static_cast<size_type>(st.st_size) != _mapping_size) {
+                ::close(fd);
+                throw std::runtime_error(
+                    "persistent_circular_buffer file size does not match the capacity");
+            }
+
+            if(created && ::ftruncate(fd, static_cast<off_t>(_mapping_size)) == -1) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "ftruncate");
+            }
+
+            void* mapping = ::mmap(
+                JM_CB_NULLPTR, _mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if(mapping == MAP_FAILED)
+                throw std::system_error(error, std::generic_category(), "mmap");
+
+            _mapping = static_cast<unsigned char*>(mapping);
+            _header  = reinterpret_cast<header_type*>(_mapping);
+            _data    = reinterpret_cast<T*>(_mapping + data_offset());
+
+            if(created)
+                initialize_header(capacity);
+        }
+
+        void initialize_header(size_type capacity) JM_CB_NOEXCEPT
+        {
+            header_type& h   = *_header;
+            h.magic          = detail::cb_persistent_magic;
+            h.version        = detail::cb_persistent_version;
+            h.element_size   = static_cast<std::uint32_t>(sizeof(T));
+            h.capacity       = capacity;
+            h.flushed_pushed = 0;
+            h.flushed_popped = 0;
+            h.pushed         = 0;
+            h.popped         = 0;
+            h.checksum       = detail::cb_header_checksum(h);
+        }
+
+        void recover(size_type capacity, persistent_recovery recovery)
+        {
+            header_type& h = *_header;
+            if(h.magic != detail::cb_persistent_magic ||
+               h.version != detail::cb_persistent_version ||
+               h.element_size != sizeof(T) || h.capacity != capacity ||
+               h.checksum != detail::cb_header_checksum(h))
+                throw std::runtime_error(
+                    "persistent_circular_buffer file header is invalid or does not match");
+
+            // live counters that went backwards or past each other can only come from
+            // a partially written back file. There is no telling how many pushes
+            // overwrote the checkpoint then, so none of its elements can be trusted.
+            const bool live_consistent = h.popped <= h.pushed &&
+                                         h.flushed_pushed <= h.pushed &&
+                                         h.flushed_popped <= h.popped;
+            if(!live_consistent) {
+                h.pushed = h.flushed_pushed;
+                h.popped = h.flushed_pushed;
+            }
+            else if(recovery == persistent_recovery::flushed) {
+                // the pushes after the checkpoint overwrote its oldest elements, and a
+                // crash in the middle of the next push may have torn one more
+                std::uint64_t popped = h.flushed_popped;
+                if(h.pushed >= capacity && popped < h.pushed - capacity + 1)
+                    popped = h.pushed - capacity + 1;
+
+                h.pushed = h.flushed_pushed;
+                h.popped = (std::min)(popped, h.flushed_pushed);
+            }
+
+            // files written before pushes retired what they overwrote can have pops
+            // behind the overwrites, those are implied by the push counter
+            std::uint64_t popped = h.popped;
+            if(h.pushed - popped > capacity)
+                popped = h.pushed - capacity;
+
+            _pushed = h.pushed;
+            _size   = static_cast<size_type>(h.pushed - popped);
+            _head   = static_cast<size_type>(popped % capacity);
+            _tail   = static_cast<size_type>(h.pushed % capacity);
+        }
+
+        void release() JM_CB_NOEXCEPT
+        {
+            if(_mapping != JM_CB_NULLPTR)
+                ::munmap(_mapping, _mapping_size);
+        }
+
+    public:
+        /// opens the ring stored at path, creating the file when it does not exist or
+        /// is empty. An existing file must have been created with the same T and
+        /// capacity, otherwise std::runtime_error is thrown. Failing system calls throw
+        /// std::system_error.
+        persistent_circular_buffer(const char*         path,
+                                   size_type           capacity,
+                                   persistent_recovery recovery = persistent_recovery::latest)
+            : _mapping(JM_CB_NULLPTR)
+            , _mapping_size(0)
+            , _header(JM_CB_NULLPTR)
+            , _data(JM_CB_NULLPTR)
+            , _capacity(capacity)
+            , _head(0)
+            , _tail(0)
+            , _size(0)
+            , _pushed(0)
+        {
+            if(JM_CB_UNLIKELY(capacity == 0))
+                throw std::invalid_argument(
+                    "persistent_circular_buffer<T>(const char*, size_type) capacity == 0");
+
+            map_file(path, capacity);
+            try {
+                recover(capacity, recovery);
+            } catch(...) {
+                release();
+                throw;
+            }
+        }
+
+        persistent_circular_buffer(const persistent_circular_buffer&) = delete;
+        persistent_circular_buffer& operator=(const persistent_circular_buffer&) = delete;
+
+        persistent_circular_buffer(persistent_circular_buffer&& other) JM_CB_NOEXCEPT
+            : _mapping(other._mapping)
+            , _mapping_size(other._mapping_size)
+            , _header(other._header)
+            , _data(other._data)
+            , _capacity(other._capacity)
+            , _head(other._head)
+            , _tail(other._tail)
+            , _size(other._size)
+            , _pushed(other._pushed)
+        {
+            other._mapping = JM_CB_NULLPTR;
+            other._header  = JM_CB_NULLPTR;
+            other._data    = JM_CB_NULLPTR;
+            other._size    = 0;
+        }
+
+        persistent_circular_buffer& operator=(persistent_circular_buffer&& other) JM_CB_NOEXCEPT
+        {
+            swap(other);
+            return *this;
+        }
+
+        /// unmaps the file without flushing, the kernel still writes the pages back
+        ~persistent_circular_buffer() { release(); }
+
+        void swap(persistent_circular_buffer& other) JM_CB_NOEXCEPT
+        {
+            std::swap(_mapping, other._mapping);
+            std::swap(_mapping_size, other._mapping_size);
+            std::swap(_header, other._header);
+            std::swap(_data, other._data);
+            std::swap(_capacity, other._capacity);
+            std::swap(_head, other._head);
+            std::swap(_tail, other._tail);
+            std::swap(_size, other._size);
+            std::swap(_pushed, other._pushed);
+        }
+
+        friend void swap(persistent_circular_buffer& lhs, persistent_circular_buffer& rhs)
+            JM_CB_NOEXCEPT
+        {
+            lhs.swap(rhs);
+        }
+
+        /// capacity
+        bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
+
+        bool full() const JM_CB_NOEXCEPT { return _size == _capacity; }
+
+        size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+        size_type capacity() const JM_CB_NOEXCEPT { return _capacity; }
+
+        size_type max_size() const JM_CB_NOEXCEPT { return _capacity; }
+
+        /// element access
+        const_reference front() const JM_CB_NOEXCEPT { return _data[_head]; }
+
+        const_reference back() const JM_CB_NOEXCEPT
+        {
+            return _data[_tail == 0 ? _capacity - 1 : _tail - 1];
+        }
+
+        const_reference operator[](size_type pos) const JM_CB_NOEXCEPT
+        {
+            return _data[wrap(_head + pos)];
+        }
+
+        /// the elements in logical order as at most two contiguous runs
+        const_array_range array_one() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(_data + _head, (std::min)(_size, _capacity - _head));
+        }
+
+        const_array_range array_two() const JM_CB_NOEXCEPT
+        {
+            return const_array_range(_data, _size - (std::min)(_size, _capacity - _head));
+        }
+
+        /// modifiers
+        /// appends value, overwriting the oldest element when the buffer is full
+        void push_back(const T& value) JM_CB_NOEXCEPT
+        {
+            const bool overwrite = _size == _capacity;
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(overwrite)) {
+                // the oldest element leaves the recoverable state before its slot is
+                // written, a crash in between must not restore a half written front()
+                _header->popped = _pushed - _size + 1;
+                publish_barrier();
+            }
+
+            _data[_tail] = value;
+            _tail        = wrap(_tail + 1);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(overwrite))
+                _head = _tail;
+            else
+                ++_size;
+
+            publish_barrier();
+            _header->pushed = ++_pushed;
+        }
+
+        void pop_front() JM_CB_NOEXCEPT
+        {
+            _head = wrap(_head + 1);
+            --_size;
+            _header->popped = _pushed - _size;
+        }
+
+        /// removes the first n elements, n must not exceed size()
+        void pop_front(size_type n) JM_CB_NOEXCEPT
+        {
+            _head = wrap(_head + n);
+            _size -= n;
+            _header->popped = _pushed - _size;
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            _head           = _tail;
+            _size           = 0;
+            _header->popped = _pushed;
+        }
+
+        /// writes the mapping back to the file and saves the current state as the
+        /// checkpoint that persistent_recovery::flushed restores. The elements reach the
+        /// disk before the checkpoint that refers to them.
+        void flush()
+        {
+            if(::msync(_mapping, _mapping_size, MS_SYNC) == -1)
+                throw std::system_error(errno, std::generic_category(), "msync");
+
+            header_type& h   = *_header;
+            h.flushed_pushed = h.pushed;
+            h.flushed_popped = h.popped;
+            h.checksum       = detail::cb_header_checksum(h);
+
+            if(::msync(_mapping, sizeof(header_type), MS_SYNC) == -1)
+                throw std::system_error(errno, std::generic_category(), "msync");
+        }
+    };
+
+} // namespace jm
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // include guard
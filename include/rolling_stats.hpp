@@ -0,0 +1,230 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_ROLLING_STATS_HPP
+#define JM_ROLLING_STATS_HPP
+
+#include "circular_buffer.hpp"
+
+namespace jm {
+
+    namespace detail {
+
+        // sums with four independent lanes so that the loop can be vectorized without
+        // reassociating floating point additions
+        template<class R, class T>
+        R cb_lane_sum(const T* first, std::size_t n, R init)
+        {
+            R           lanes[4] = { init, R(), R(), R() };
+            std::size_t i        = 0;
+            for(; i + 4 <= n; i += 4) {
+                lanes[0] += static_cast<R>(first[i]);
+                lanes[1] += static_cast<R>(first[i + 1]);
+                lanes[2] += static_cast<R>(first[i + 2]);
+                lanes[3] += static_cast<R>(first[i + 3]);
+            }
+
+            for(; i < n; ++i)
+                lanes[0] += static_cast<R>(first[i]);
+
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+
+        template<class R, class T>
+        R cb_lane_squared_deviation(const T* first, std::size_t n, R mean, R init)
+        {
+            R           lanes[4] = { init, R(), R(), R() };
+            std::size_t i        = 0;
+            for(; i + 4 <= n; i += 4) {
+                const R d0 = static_cast<R>(first[i]) - mean;
+                const R d1 = static_cast<R>(first[i + 1]) - mean;
+                const R d2 = static_cast<R>(first[i + 2]) - mean;
+                const R d3 = static_cast<R>(first[i + 3]) - mean;
+                lanes[0] += d0 * d0;
+                lanes[1] += d1 * d1;
+                lanes[2] += d2 * d2;
+                lanes[3] += d3 * d3;
+            }
+
+            for(; i < n; ++i) {
+                const R d = static_cast<R>(first[i]) - mean;
+                lanes[0] += d * d;
+            }
+
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+
+    } // namespace detail
+
+    /// a circular_buffer window that keeps its sum, mean and variance up to date in O(1)
+    /// per push. The sum is compensated (Kahan-Babuska), the mean is derived from it and
+    /// the variance uses Welford's update, with the element that a push evicts from a
+    /// full window removed in the same step. Long running windows can call recompute()
+    /// now and then to get rid of the remaining rounding drift.
+    template<typename T, std::size_t N, class Index = modulo_index>
+    class rolling_stats {
+    public:
+        typedef circular_buffer<T, N, Index> window_type;
+        typedef typename window_type::size_type size_type;
+
+        /// integers are accumulated as double
+        typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type
+            result_type;
+
+    private:
+        JM_CB_STATIC_ASSERT(N != 0, "rolling_stats requires N > 0");
+
+        window_type _window;
+        result_type _sum;
+        result_type _compensation;
+        result_type _m2;
+
+        void add_to_sum(result_type value) JM_CB_NOEXCEPT
+        {
+            const result_type t = _sum + value;
+            if((_sum < 0 ? -_sum : _sum) >= (value < 0 ? -value : value))
+                _compensation += (_sum - t) + value;
+            else
+                _compensation += (value - t) + _sum;
+            _sum = t;
+        }
+
+        // the mean is always derived from the compensated sum, a separately updated
+        // mean accumulates the rounding error of every step
+        result_type mean_of(size_type n) const JM_CB_NOEXCEPT
+        {
+            return n == 0 ? result_type() : sum() / static_cast<result_type>(n);
+        }
+
+        void add(result_type x) JM_CB_NOEXCEPT
+        {
+            const result_type old_mean = mean_of(_window.size() - 1);
+            add_to_sum(x);
+            _m2 += (x - old_mean) * (x - mean());
+        }
+
+        void remove(result_type x) JM_CB_NOEXCEPT
+        {
+            const result_type old_mean = mean_of(_window.size() + 1);
+            add_to_sum(-x);
+            if(_window.empty())
+                reset();
+            else
+                _m2 -= (x - old_mean) * (x - mean());
+        }
+
+        // a full window where x_new evicts x_old, the count does not change
+        void replace(result_type x_old, result_type x_new) JM_CB_NOEXCEPT
+        {
+            const result_type old_mean = mean();
+            add_to_sum(x_new - x_old);
+            _m2 += (x_new - x_old) * ((x_new - mean()) + (x_old - old_mean));
+        }
+
+        void reset() JM_CB_NOEXCEPT
+        {
+            _sum          = result_type();
+            _compensation = result_type();
+            _m2           = result_type();
+        }
+
+    public:
+        rolling_stats() : _window(), _sum(), _compensation(), _m2() {}
+
+        /// appends value, evicting the oldest element once the window holds N elements
+        void push(const T& value)
+        {
+            if(_window.full()) {
+                const result_type evicted = static_cast<result_type>(_window.front());
+                _window.push_back(value);
+                replace(evicted, static_cast<result_type>(value));
+            }
+            else {
+                _window.push_back(value);
+                add(static_cast<result_type>(value));
+            }
+        }
+
+        /// removes the oldest element, the window must not be empty
+        void pop()
+        {
+            const result_type oldest = static_cast<result_type>(_window.front());
+            _window.pop_front();
+            remove(oldest);
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            _window.clear();
+            reset();
+        }
+
+        /// recomputes every statistic from the window contents in two passes over
+        /// array_one() and array_two()
+        void recompute()
+        {
+            typedef typename window_type::const_array_range range;
+
+            const window_type& window = _window;
+            const range        one    = window.array_one();
+            const range        two    = window.array_two();
+
+            reset();
+            if(window.empty())
+                return;
+
+            _sum = detail::cb_lane_sum(
+                two.first, two.second, detail::cb_lane_sum(one.first, one.second, result_type()));
+            const result_type mean = this->mean();
+            _m2                    = detail::cb_lane_squared_deviation(
+                two.first,
+                two.second,
+                mean,
+                detail::cb_lane_squared_deviation(one.first, one.second, mean, result_type()));
+        }
+
+        const window_type& window() const JM_CB_NOEXCEPT { return _window; }
+
+        size_type count() const JM_CB_NOEXCEPT { return _window.size(); }
+
+        bool empty() const JM_CB_NOEXCEPT { return _window.empty(); }
+
+        bool full() const JM_CB_NOEXCEPT { return _window.full(); }
+
+        result_type sum() const JM_CB_NOEXCEPT { return _sum + _compensation; }
+
+        result_type mean() const JM_CB_NOEXCEPT { return mean_of(_window.size()); }
+
+        /// population variance, 0 for an empty window
+        result_type variance() const JM_CB_NOEXCEPT
+        {
+            return _window.empty() || _m2 < 0
+                       ? result_type()
+                       : _m2 / static_cast<result_type>(_window.size());
+        }
+
+        /// variance with Bessel's correction, 0 for less than two elements
+        result_type sample_variance() const JM_CB_NOEXCEPT
+        {
+            return _window.size() < 2 || _m2 < 0
+                       ? result_type()
+                       : _m2 / static_cast<result_type>(_window.size() - 1);
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
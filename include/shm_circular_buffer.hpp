@@ -0,0 +1,361 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_SHM_CIRCULAR_BUFFER_HPP
+#define JM_SHM_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jm {
+
+    namespace detail {
+
+        JM_CB_STATIC_ASSERT(ATOMIC_LLONG_LOCK_FREE == 2,
+                            "shared memory counters must be lock free");
+
+        // start of the shared region. It holds no pointers, the elements are found at
+        // data_offset from the start of each process' own mapping.
+        struct cb_shm_control {
+            alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<std::uint64_t> magic; // stored last
+            std::uint32_t version;
+            std::uint32_t element_size;
+            std::uint64_t capacity;
+            std::uint64_t data_offset;
+
+            alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<std::uint64_t> head;
+            alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<std::uint64_t> tail;
+        };
+
+        const std::uint64_t cb_shm_magic   = 0x4a4d53484d524e47ull; // "JMSHMRNG"
+        const std::uint32_t cb_shm_version = 1;
+
+    } // namespace detail
+
+    /// lock free single producer single consumer queue of trivially copyable elements
+    /// in a shared memory region, e.g. from shm_open or memfd_create, for one producer
+    /// and one consumer process. Every process maps the region through its own
+    /// shm_spsc_circular_buffer and the region itself only stores offsets and free
+    /// running counters, so the mapping addresses may differ. Like
+    /// spsc_circular_buffer each side keeps a cached copy of the other side's counter.
+    template<typename T>
+    class shm_spsc_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+    private:
+        JM_CB_STATIC_ASSERT(JM_CB_IS_TRIVIALLY_COPYABLE(T),
+                            "shm_spsc_circular_buffer requires a trivially copyable T");
+
+        typedef detail::cb_shm_control control_type;
+
+        void*         _mapping;
+        size_type     _mapping_size;
+        control_type* _control;
+        T*            _data;
+        size_type     _capacity;
+        std::uint64_t _cached_head; // producer side
+        std::uint64_t _cached_tail; // consumer side
+
+        static size_type data_offset() noexcept
+        {
+            return (sizeof(control_type) + alignof(T) - 1) / alignof(T) * alignof(T);
+        }
+
+        T* slot(std::uint64_t pos) const noexcept
+        {
+            return _data + static_cast<size_type>(pos % _capacity);
+        }
+
+        size_type producer_free(std::uint64_t tail, size_type want) noexcept
+        {
+            size_type free = _capacity - static_cast<size_type>(tail - _cached_head);
+            if(free < want) {
+                _cached_head = _control->head.load(std::memory_order_acquire);
+                free         = _capacity - static_cast<size_type>(tail - _cached_head);
+            }
+
+            return free;
+        }
+
+        size_type consumer_available(std::uint64_t head, size_type want) noexcept
+        {
+            size_type available = static_cast<size_type>(_cached_tail - head);
+            if(available < want) {
+                _cached_tail = _control->tail.load(std::memory_order_acquire);
+                available    = static_cast<size_type>(_cached_tail - head);
+            }
+
+            return available;
+        }
+
+        template<class ContiguousIt>
+        void write_n(std::uint64_t tail, ContiguousIt first, size_type n, std::true_type) noexcept
+        {
+            const T*        src     = detail::cb_to_address(first);
+            T*              dst     = slot(tail);
+            const size_type first_n = (std::min)(n, static_cast<size_type>(_data + _capacity - dst));
+
+            std::memcpy(dst, src, first_n * sizeof(T));
+            if(first_n != n)
+                std::memcpy(_data, src + first_n, (n - first_n) * sizeof(T));
+        }
+
+        template<class InputIt>
+        void write_n(std::uint64_t tail, InputIt first, size_type n, std::false_type)
+        {
+            for(size_type i = 0; i < n; ++i, ++first)
+                *slot(tail + i) = *first;
+        }
+
+        template<class ContiguousIt>
+        void read_n(std::uint64_t head, ContiguousIt dst, size_type n, std::true_type) noexcept
+        {
+            T*              out     = detail::cb_to_address(dst);
+            const T*        src     = slot(head);
+            const size_type first_n = (std::min)(n, static_cast<size_type>(_data + _capacity - src));
+
+            std::memcpy(out, src, first_n * sizeof(T));
+            if(first_n != n)
+                std::memcpy(out + first_n, _data, (n - first_n) * sizeof(T));
+        }
+
+        template<class OutputIt>
+        void read_n(std::uint64_t head, OutputIt dst, size_type n, std::false_type)
+        {
+            for(size_type i = 0; i < n; ++i, ++dst)
+                *dst = *slot(head + i);
+        }
+
+        void map(int fd, size_type size)
+        {
+            _mapping = ::mmap(JM_CB_NULLPTR, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(_mapping == MAP_FAILED) {
+                _mapping = JM_CB_NULLPTR;
+                throw std::system_error(errno, std::generic_category(), "mmap");
+            }
+
+            _mapping_size = size;
+            _control      = static_cast<control_type*>(_mapping);
+        }
+
+        void validate(size_type size)
+        {
+            const control_type& c = *_control;
+            if(c.magic.load(std::memory_order_acquire) != detail::cb_shm_magic ||
+               c.version != detail::cb_shm_version || c.element_size != sizeof(T) ||
+               c.data_offset != data_offset() || c.capacity == 0 ||
+               c.capacity > (size - data_offset()) / sizeof(T))
+                throw std::runtime_error(
+                    "shm_spsc_circular_buffer region is not initialized or does not match");
+
+            _capacity = static_cast<size_type>(c.capacity);
+        }
+
+        void release() noexcept
+        {
+            if(_mapping != JM_CB_NULLPTR)
+                ::munmap(_mapping, _mapping_size);
+        }
+
+        shm_spsc_circular_buffer() noexcept
+            : _mapping(JM_CB_NULLPTR)
+            , _mapping_size(0)
+            , _control(JM_CB_NULLPTR)
+            , _data(JM_CB_NULLPTR)
+            , _capacity(0)
+            , _cached_head(0)
+            , _cached_tail(0)
+        {}
+
+    public:
+        /// bytes of shared memory a queue of the given capacity occupies
+        static size_type region_size(size_type capacity) noexcept
+        {
+            return data_offset() + capacity * sizeof(T);
+        }
+
+        /// sizes the shared memory object behind fd and initializes a queue in it.
+        /// Failing system calls throw std::system_error.
+        static shm_spsc_circular_buffer create(int fd, size_type capacity)
+        {
+            if(JM_CB_UNLIKELY(capacity == 0))
+                throw std::invalid_argument(
+                    "shm_spsc_circular_buffer<T>::create(int, size_type) capacity == 0");
+
+            const size_type size = region_size(capacity);
+            if(::ftruncate(fd, static_cast<off_t>(size)) == -1)
+                throw std::system_error(errno, std::generic_category(), "ftruncate");
+
+            shm_spsc_circular_buffer cb;
+            cb.map(fd, size);
+            cb._data     = reinterpret_cast<T*>(static_cast<unsigned char*>(cb._mapping) +
+                                            data_offset());
+            cb._capacity = capacity;
+
+            control_type& c = *cb._control;
+            c.version       = detail::cb_shm_version;
+            c.element_size  = static_cast<std::uint32_t>(sizeof(T));
+            c.capacity      = capacity;
+            c.data_offset   = data_offset();
+            c.head.store(0, std::memory_order_relaxed);
+            c.tail.store(0, std::memory_order_relaxed);
+            c.magic.store(detail::cb_shm_magic, std::memory_order_release);
+            return cb;
+        }
+
+        /// maps a queue that another process created with create(). The header must
+        /// match T and the capacity must fit the region, otherwise std::runtime_error
+        /// is thrown.
+        static shm_spsc_circular_buffer attach(int fd)
+        {
+            struct stat st;
+            if(::fstat(fd, &st) == -1)
+                throw std::system_error(errno, std::generic_category(), "fstat");
+
+            const size_type size = static_cast<size_type>(st.st_size);
+            if(size < data_offset())
+                throw std::runtime_error(
+                    "shm_spsc_circular_buffer region is smaller than its header");
+
+            shm_spsc_circular_buffer cb;
+            cb.map(fd, size);
+            cb.validate(size);
+            cb._data        = reinterpret_cast<T*>(static_cast<unsigned char*>(cb._mapping) +
+                                            data_offset());
+            cb._cached_head = cb._control->head.load(std::memory_order_acquire);
+            cb._cached_tail = cb._control->tail.load(std::memory_order_acquire);
+            return cb;
+        }
+
+        shm_spsc_circular_buffer(const shm_spsc_circular_buffer&) = delete;
+        shm_spsc_circular_buffer& operator=(const shm_spsc_circular_buffer&) = delete;
+
+        shm_spsc_circular_buffer(shm_spsc_circular_buffer&& other) noexcept
+            : _mapping(other._mapping)
+            , _mapping_size(other._mapping_size)
+            , _control(other._control)
+            , _data(other._data)
+            , _capacity(other._capacity)
+            , _cached_head(other._cached_head)
+            , _cached_tail(other._cached_tail)
+        {
+            other._mapping = JM_CB_NULLPTR;
+            other._control = JM_CB_NULLPTR;
+            other._data    = JM_CB_NULLPTR;
+        }
+
+        shm_spsc_circular_buffer& operator=(shm_spsc_circular_buffer&& other) noexcept
+        {
+            std::swap(_mapping, other._mapping);
+            std::swap(_mapping_size, other._mapping_size);
+            std::swap(_control, other._control);
+            std::swap(_data, other._data);
+            std::swap(_capacity, other._capacity);
+            std::swap(_cached_head, other._cached_head);
+            std::swap(_cached_tail, other._cached_tail);
+            return *this;
+        }
+
+        /// unmaps this process' view, the shared memory object and fd are left alone
+        ~shm_spsc_circular_buffer() { release(); }
+
+        /// capacity, only approximate while the other process is running
+        bool empty() const noexcept { return size() == 0; }
+
+        bool full() const noexcept { return size() == _capacity; }
+
+        size_type size() const noexcept
+        {
+            const std::uint64_t head = _control->head.load(std::memory_order_acquire);
+            return static_cast<size_type>(_control->tail.load(std::memory_order_acquire) - head);
+        }
+
+        size_type capacity() const noexcept { return _capacity; }
+
+        /// producer
+        bool try_push(const value_type& value) noexcept
+        {
+            const std::uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(producer_free(tail, 1) == 0))
+                return false;
+
+            *slot(tail) = value;
+            _control->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// pushes as many elements of [first, last) as fit and returns their count,
+        /// the elements are published to the consumer all at once
+        template<typename ForwardIt,
+                 typename std::enable_if<!std::is_integral<ForwardIt>::value, int>::type = 0>
+        size_type try_push(ForwardIt first, ForwardIt last)
+        {
+            const std::uint64_t tail = _control->tail.load(std::memory_order_relaxed);
+            const size_type     want = static_cast<size_type>(std::distance(first, last));
+            const size_type     n    = (std::min)(want, producer_free(tail, want));
+
+            write_n(tail, first, n, detail::cb_is_memcpyable<ForwardIt, T>());
+            _control->tail.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        /// consumer
+        bool try_pop(value_type& out) noexcept
+        {
+            const std::uint64_t head = _control->head.load(std::memory_order_relaxed);
+            if(consumer_available(head, 1) == 0)
+                return false;
+
+            out = *slot(head);
+            _control->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// copies up to n elements into dst and returns their count
+        template<class OutputIt>
+        size_type try_pop(OutputIt dst, size_type n)
+        {
+            const std::uint64_t head = _control->head.load(std::memory_order_relaxed);
+            n                        = (std::min)(n, consumer_available(head, n));
+
+            read_n(head, dst, n, detail::cb_is_memcpyable<OutputIt, T>());
+            _control->head.store(head + n, std::memory_order_release);
+            return n;
+        }
+    };
+
+} // namespace jm
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // include guard
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_SLIDING_MIN_MAX_HPP
+#define JM_SLIDING_MIN_MAX_HPP
+
+#include "circular_buffer.hpp"
+
+#include <functional>
+
+namespace jm {
+
+    /// minimum and maximum of a sliding window in amortized O(1) per push and O(1) per
+    /// query. Two monotonic deques, each a circular_buffer of (value, key) entries, keep
+    /// only the elements that can still become the extremum: a push pops every entry
+    /// from the back that the new value dominates, expiry pops entries from the front.
+    ///
+    /// The window is either the last N pushes when using push(value), or every entry
+    /// whose key is not older than the one passed to expire_before() when using
+    /// push(value, key) with non decreasing keys such as timestamps. In the keyed mode N
+    /// bounds the number of candidates kept, once exceeded the oldest candidate is
+    /// dropped. Monotonic input is the only way to get there.
+    template<typename T,
+             std::size_t N,
+             class Compare = std::less<T>,
+             class Key     = std::size_t,
+             class Index   = modulo_index>
+    class sliding_min_max {
+    public:
+        typedef T           value_type;
+        typedef Key         key_type;
+        typedef Compare     value_compare;
+        typedef std::size_t size_type;
+
+    private:
+        JM_CB_STATIC_ASSERT(N != 0, "sliding_min_max requires N > 0");
+
+        struct entry {
+            T   value;
+            Key key;
+
+            entry(const T& v, const Key& k) : value(v), key(k) {}
+        };
+
+        typedef circular_buffer<entry, N, Index> deque_type;
+
+        deque_type _min;
+        deque_type _max;
+        Compare    _comp;
+        size_type  _pushed;
+
+        static void expire(deque_type& deque, const Key& key)
+        {
+            while(!deque.empty() && deque.front().key < key)
+                deque.pop_front();
+        }
+
+    public:
+        explicit sliding_min_max(const Compare& comp = Compare())
+            : _min(), _max(), _comp(comp), _pushed(0)
+        {}
+
+        /// appends value to a window of the last N pushes
+        void push(const T& value)
+        {
+            push(value, static_cast<Key>(_pushed));
+            if(_pushed > N)
+                expire_before(static_cast<Key>(_pushed - N));
+        }
+
+        /// appends value with key, keys must not decrease between pushes
+        void push(const T& value, const Key& key)
+        {
+            while(!_min.empty() && !_comp(_min.back().value, value))
+                _min.pop_back();
+            while(!_max.empty() && !_comp(value, _max.back().value))
+                _max.pop_back();
+
+            _min.emplace_back(value, key);
+            _max.emplace_back(value, key);
+            ++_pushed;
+        }
+
+        /// removes every element pushed with a key less than key
+        void expire_before(const Key& key)
+        {
+            expire(_min, key);
+            expire(_max, key);
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            _min.clear();
+            _max.clear();
+            _pushed = 0;
+        }
+
+        /// the newest element is always a candidate for both, so both deques are
+        /// empty at the same time
+        bool empty() const JM_CB_NOEXCEPT { return _min.empty(); }
+
+        /// the smallest element of the window according to Compare, the window must not
+        /// be empty
+        const T& min() const JM_CB_NOEXCEPT { return _min.front().value; }
+
+        /// the largest element of the window according to Compare
+        const T& max() const JM_CB_NOEXCEPT { return _max.front().value; }
+
+        const Key& min_key() const JM_CB_NOEXCEPT { return _min.front().key; }
+
+        const Key& max_key() const JM_CB_NOEXCEPT { return _max.front().key; }
+    };
+
+} // namespace jm
+
+#endif // include guard
@@ -0,0 +1,632 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_SOA_CIRCULAR_BUFFER_HPP
+#define JM_SOA_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#include <tuple>
+
+namespace jm {
+
+    namespace detail {
+
+        template<std::size_t... Is>
+        struct cb_index_sequence {
+        };
+
+        template<std::size_t N, std::size_t... Is>
+        struct cb_make_index_sequence : cb_make_index_sequence<N - 1, N - 1, Is...> {
+        };
+
+        template<std::size_t... Is>
+        struct cb_make_index_sequence<0, Is...> {
+            typedef cb_index_sequence<Is...> type;
+        };
+
+        // one column of the buffer, the index keeps columns of the same type apart
+        template<std::size_t I, std::size_t N, class T>
+        struct cb_soa_column {
+            JM_CB_STATIC_ASSERT(sizeof(optional_storage<T>) == sizeof(T) &&
+                                    alignof(optional_storage<T>) == alignof(T),
+                                "storage must be layout compatible with an array of T");
+
+            optional_storage<T> _column[N];
+
+            JM_CB_CONSTEXPR cb_soa_column() JM_CB_NOEXCEPT : _column() {}
+        };
+
+        template<class Indices, std::size_t N, class... Ts>
+        struct cb_soa_columns;
+
+        template<std::size_t... Is, std::size_t N, class... Ts>
+        struct cb_soa_columns<cb_index_sequence<Is...>, N, Ts...>
+            : cb_soa_column<Is, N, Ts>... {
+        };
+
+        // evaluates its arguments for their side effects, expanding a pack in order
+        struct cb_expand {
+            template<class... Args>
+            JM_CB_CXX14_CONSTEXPR cb_expand(Args&&...) JM_CB_NOEXCEPT
+            {}
+        };
+
+        /// random access proxy iterator over the rows of a soa_circular_buffer, it
+        /// dereferences to a tuple of references to the fields of a row
+        template<class Buffer, class Reference>
+        class cb_soa_iterator {
+            template<class, class>
+            friend class cb_soa_iterator;
+
+            Buffer*     _cb;
+            std::size_t _pos;
+
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef typename Buffer::value_type     value_type;
+            typedef std::ptrdiff_t                  difference_type;
+            typedef Reference                       reference;
+            typedef void                            pointer;
+
+            JM_CB_CONSTEXPR cb_soa_iterator() JM_CB_NOEXCEPT : _cb(JM_CB_NULLPTR), _pos(0) {}
+
+            JM_CB_CONSTEXPR cb_soa_iterator(Buffer* cb, std::size_t pos) JM_CB_NOEXCEPT
+                : _cb(cb),
+                  _pos(pos)
+            {}
+
+            template<class B, class R>
+            JM_CB_CONSTEXPR cb_soa_iterator(const cb_soa_iterator<B, R>& other) JM_CB_NOEXCEPT
+                : _cb(other._cb),
+                  _pos(other._pos)
+            {}
+
+            reference operator*() const JM_CB_NOEXCEPT { return (*_cb)[_pos]; }
+
+            reference operator[](difference_type n) const JM_CB_NOEXCEPT
+            {
+                return (*_cb)[_pos + n];
+            }
+
+            cb_soa_iterator& operator++() JM_CB_NOEXCEPT
+            {
+                ++_pos;
+                return *this;
+            }
+
+            cb_soa_iterator operator++(int) JM_CB_NOEXCEPT
+            {
+                cb_soa_iterator tmp = *this;
+                ++_pos;
+                return tmp;
+            }
+
+            cb_soa_iterator& operator--() JM_CB_NOEXCEPT
+            {
+                --_pos;
+                return *this;
+            }
+
+            cb_soa_iterator operator--(int) JM_CB_NOEXCEPT
+            {
+                cb_soa_iterator tmp = *this;
+                --_pos;
+                return tmp;
+            }
+
+            cb_soa_iterator& operator+=(difference_type n) JM_CB_NOEXCEPT
+            {
+                _pos += n;
+                return *this;
+            }
+
+            cb_soa_iterator& operator-=(difference_type n) JM_CB_NOEXCEPT
+            {
+                _pos -= n;
+                return *this;
+            }
+
+            cb_soa_iterator operator+(difference_type n) const JM_CB_NOEXCEPT
+            {
+                return cb_soa_iterator(_cb, _pos + n);
+            }
+
+            friend cb_soa_iterator operator+(difference_type n, const cb_soa_iterator& it)
+                JM_CB_NOEXCEPT
+            {
+                return it + n;
+            }
+
+            cb_soa_iterator operator-(difference_type n) const JM_CB_NOEXCEPT
+            {
+                return cb_soa_iterator(_cb, _pos - n);
+            }
+
+            template<class B, class R>
+            difference_type operator-(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return static_cast<difference_type>(_pos) -
+                       static_cast<difference_type>(other._pos);
+            }
+
+            template<class B, class R>
+            bool operator==(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return _pos == other._pos && _cb == other._cb;
+            }
+
+            template<class B, class R>
+            bool operator!=(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return !(*this == other);
+            }
+
+            template<class B, class R>
+            bool operator<(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return _pos < other._pos;
+            }
+
+            template<class B, class R>
+            bool operator>(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return _pos > other._pos;
+            }
+
+            template<class B, class R>
+            bool operator<=(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return _pos <= other._pos;
+            }
+
+            template<class B, class R>
+            bool operator>=(const cb_soa_iterator<B, R>& other) const JM_CB_NOEXCEPT
+            {
+                return _pos >= other._pos;
+            }
+        };
+
+    } // namespace detail
+
+    /// circular_buffer of records stored as a struct of arrays: every field of the
+    /// record lives in its own array of N elements and all of them share one head, tail
+    /// and size. Scans over a single field only touch that field's memory and, through
+    /// array_one<I>() and array_two<I>(), run over plain arrays that the compiler can
+    /// vectorize. Rows are pushed as tuples or field by field with emplace_back and are
+    /// read back as tuples of references.
+    template<std::size_t N, class... Ts>
+    class soa_circular_buffer {
+    public:
+        typedef std::tuple<Ts...>        value_type;
+        typedef std::tuple<Ts&...>       reference;
+        typedef std::tuple<const Ts&...> const_reference;
+        typedef std::size_t              size_type;
+        typedef std::ptrdiff_t           difference_type;
+
+        /// the type of field I
+        template<std::size_t I>
+        using field_type = typename std::tuple_element<I, value_type>::type;
+
+        /// a contiguous run of field I as a (pointer, length) pair
+        template<std::size_t I>
+        using array_range = std::pair<field_type<I>*, size_type>;
+
+        template<std::size_t I>
+        using const_array_range = std::pair<const field_type<I>*, size_type>;
+
+        typedef detail::cb_soa_iterator<soa_circular_buffer, reference>             iterator;
+        typedef detail::cb_soa_iterator<const soa_circular_buffer, const_reference> const_iterator;
+        typedef std::reverse_iterator<iterator>       reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    private:
+        JM_CB_STATIC_ASSERT(N != 0, "soa_circular_buffer requires N > 0");
+        JM_CB_STATIC_ASSERT(sizeof...(Ts) != 0, "soa_circular_buffer requires a field");
+
+        typedef typename detail::cb_make_index_sequence<sizeof...(Ts)>::type indices;
+        typedef typename detail::cb_index_type<N>::type                     index_type;
+        typedef detail::cb_index_wrapper<size_type, N, modulo_index>         wrapper_t;
+        typedef detail::cb_soa_columns<indices, N, Ts...>                    columns_type;
+
+        index_type   _head;
+        index_type   _tail;
+        index_type   _size;
+        columns_type _columns;
+
+        template<std::size_t I>
+        field_type<I>* column() JM_CB_NOEXCEPT
+        {
+            typedef detail::cb_soa_column<I, N, field_type<I>> column_type;
+            return JM_CB_ADDRESSOF(static_cast<column_type&>(_columns)._column[0]._value);
+        }
+
+        template<std::size_t I>
+        const field_type<I>* column() const JM_CB_NOEXCEPT
+        {
+            typedef detail::cb_soa_column<I, N, field_type<I>> column_type;
+            return JM_CB_ADDRESSOF(static_cast<const column_type&>(_columns)._column[0]._value);
+        }
+
+        size_type head_index() const JM_CB_NOEXCEPT { return _head; }
+
+        size_type array_one_size() const JM_CB_NOEXCEPT
+        {
+            return (std::min)(size(), N - head_index());
+        }
+
+        template<class Args>
+        void construct_fields(size_type,
+                              Args&,
+                              std::integral_constant<std::size_t, sizeof...(Ts)>) JM_CB_NOEXCEPT
+        {}
+
+        // builds fields I and up in order, destroying field I again when a later
+        // constructor throws
+        template<class Args, std::size_t I>
+        void construct_fields(size_type idx, Args& args, std::integral_constant<std::size_t, I>)
+        {
+            typedef field_type<I>                                field;
+            typedef typename std::tuple_element<I, Args>::type argument;
+
+            ::new(static_cast<void*>(column<I>() + idx))
+                field(std::forward<argument>(std::get<I>(args)));
+            try {
+                construct_fields(idx, args, std::integral_constant<std::size_t, I + 1>());
+            } catch(...) {
+                destroy_field<I>(idx);
+                throw;
+            }
+        }
+
+        // constructs the row at idx from one argument per field, if a constructor
+        // throws no field of the row is left alive
+        template<class... Args>
+        void construct(size_type idx, Args&&... args)
+        {
+            std::tuple<Args&&...> forwarded(std::forward<Args>(args)...);
+            construct_fields(idx, forwarded, std::integral_constant<std::size_t, 0>());
+        }
+
+        template<std::size_t... Is, class... Args>
+        void assign(detail::cb_index_sequence<Is...>, size_type idx, Args&&... args)
+        {
+            detail::cb_expand{ (column<Is>()[idx] = std::forward<Args>(args), 0)... };
+        }
+
+        template<std::size_t I>
+        void destroy_field(size_type idx) JM_CB_NOEXCEPT
+        {
+            typedef field_type<I> field;
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(field))
+                column<I>()[idx].~field();
+        }
+
+        template<std::size_t... Is>
+        void destroy(detail::cb_index_sequence<Is...>, size_type idx) JM_CB_NOEXCEPT
+        {
+            detail::cb_expand{ (destroy_field<Is>(idx), 0)... };
+        }
+
+        template<std::size_t... Is>
+        reference row(detail::cb_index_sequence<Is...>, size_type idx) JM_CB_NOEXCEPT
+        {
+            return reference(column<Is>()[idx]...);
+        }
+
+        template<std::size_t... Is>
+        const_reference row(detail::cb_index_sequence<Is...>, size_type idx) const JM_CB_NOEXCEPT
+        {
+            return const_reference(column<Is>()[idx]...);
+        }
+
+        template<std::size_t... Is>
+        void push_back_tuple(detail::cb_index_sequence<Is...> seq, const value_type& value)
+        {
+            const size_type new_tail = wrapper_t::increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full())) {
+                assign(seq, new_tail, std::get<Is>(value)...);
+                _head = static_cast<index_type>(wrapper_t::increment(_head));
+            }
+            else {
+                construct(new_tail, std::get<Is>(value)...);
+                ++_size;
+            }
+
+            _tail = static_cast<index_type>(new_tail);
+        }
+
+        template<std::size_t... Is>
+        void push_back_tuple(detail::cb_index_sequence<Is...>, value_type&& value)
+        {
+            emplace_back(std::move(std::get<Is>(value))...);
+        }
+
+        template<std::size_t... Is>
+        void copy_row(detail::cb_index_sequence<Is...>,
+                      size_type                        idx,
+                      const soa_circular_buffer&       other,
+                      size_type                        other_idx)
+        {
+            construct(idx, other.column<Is>()[other_idx]...);
+        }
+
+        template<std::size_t... Is>
+        void move_row(detail::cb_index_sequence<Is...>,
+                      size_type                        idx,
+                      soa_circular_buffer&             other,
+                      size_type                        other_idx)
+        {
+            construct(idx, std::move(other.column<Is>()[other_idx])...);
+        }
+
+        void reset_indices() JM_CB_NOEXCEPT
+        {
+            _head = 0;
+            _tail = static_cast<index_type>(wrapper_t::decrement(0));
+            _size = 0;
+        }
+
+        // the rows of other end up linearized at the start of the storage
+        void copy_buffer(const soa_circular_buffer& other)
+        {
+            for(size_type i = 0; i < other.size(); ++i) {
+                copy_row(indices(), i, other, wrapper_t::add(other._head, i));
+                _tail = static_cast<index_type>(i);
+                ++_size;
+            }
+        }
+
+        void move_buffer(soa_circular_buffer& other)
+        {
+            for(size_type i = 0; i < other.size(); ++i) {
+                move_row(indices(), i, other, wrapper_t::add(other._head, i));
+                _tail = static_cast<index_type>(i);
+                ++_size;
+            }
+        }
+
+    public:
+        soa_circular_buffer() JM_CB_NOEXCEPT
+            : _head(0), _tail(static_cast<index_type>(wrapper_t::decrement(0))), _size(0), _columns()
+        {}
+
+        soa_circular_buffer(const soa_circular_buffer& other)
+            : _head(0), _tail(static_cast<index_type>(wrapper_t::decrement(0))), _size(0), _columns()
+        {
+            try {
+                copy_buffer(other);
+            } catch(...) {
+                clear();
+                throw;
+            }
+        }
+
+        soa_circular_buffer(soa_circular_buffer&& other)
+            : _head(0), _tail(static_cast<index_type>(wrapper_t::decrement(0))), _size(0), _columns()
+        {
+            try {
+                move_buffer(other);
+            } catch(...) {
+                clear();
+                throw;
+            }
+        }
+
+        soa_circular_buffer& operator=(const soa_circular_buffer& other)
+        {
+            if(this != JM_CB_ADDRESSOF(other)) {
+                clear();
+                copy_buffer(other);
+            }
+
+            return *this;
+        }
+
+        soa_circular_buffer& operator=(soa_circular_buffer&& other)
+        {
+            if(this != JM_CB_ADDRESSOF(other)) {
+                clear();
+                move_buffer(other);
+            }
+
+            return *this;
+        }
+
+        ~soa_circular_buffer() { clear(); }
+
+        /// capacity
+        bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
+
+        bool full() const JM_CB_NOEXCEPT { return _size == N; }
+
+        size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+        size_type max_size() const JM_CB_NOEXCEPT { return N; }
+
+        /// element access, rows are returned as tuples of references
+        reference operator[](size_type pos) JM_CB_NOEXCEPT
+        {
+            return row(indices(), wrapper_t::add(_head, pos));
+        }
+
+        const_reference operator[](size_type pos) const JM_CB_NOEXCEPT
+        {
+            return row(indices(), wrapper_t::add(_head, pos));
+        }
+
+        reference at(size_type pos)
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range(
+                    "soa_circular_buffer<N, Ts...>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if(JM_CB_UNLIKELY(pos >= size()))
+                throw std::out_of_range(
+                    "soa_circular_buffer<N, Ts...>::at(size_type pos) pos >= size()");
+
+            return (*this)[pos];
+        }
+
+        reference front() JM_CB_NOEXCEPT { return row(indices(), _head); }
+
+        const_reference front() const JM_CB_NOEXCEPT { return row(indices(), _head); }
+
+        reference back() JM_CB_NOEXCEPT { return row(indices(), _tail); }
+
+        const_reference back() const JM_CB_NOEXCEPT { return row(indices(), _tail); }
+
+        /// field I of the row at pos
+        template<std::size_t I>
+        field_type<I>& get(size_type pos) JM_CB_NOEXCEPT
+        {
+            return column<I>()[wrapper_t::add(_head, pos)];
+        }
+
+        template<std::size_t I>
+        const field_type<I>& get(size_type pos) const JM_CB_NOEXCEPT
+        {
+            return column<I>()[wrapper_t::add(_head, pos)];
+        }
+
+        /// the storage of field I
+        template<std::size_t I>
+        field_type<I>* data() JM_CB_NOEXCEPT
+        {
+            return column<I>();
+        }
+
+        template<std::size_t I>
+        const field_type<I>* data() const JM_CB_NOEXCEPT
+        {
+            return column<I>();
+        }
+
+        /// field I of every row in logical order as at most two contiguous runs,
+        /// array_two is empty unless the rows wrap around the end of the storage
+        template<std::size_t I>
+        array_range<I> array_one() JM_CB_NOEXCEPT
+        {
+            return array_range<I>(column<I>() + head_index(), array_one_size());
+        }
+
+        template<std::size_t I>
+        const_array_range<I> array_one() const JM_CB_NOEXCEPT
+        {
+            return const_array_range<I>(column<I>() + head_index(), array_one_size());
+        }
+
+        template<std::size_t I>
+        array_range<I> array_two() JM_CB_NOEXCEPT
+        {
+            return array_range<I>(column<I>(), size() - array_one_size());
+        }
+
+        template<std::size_t I>
+        const_array_range<I> array_two() const JM_CB_NOEXCEPT
+        {
+            return const_array_range<I>(column<I>(), size() - array_one_size());
+        }
+
+        /// modifiers
+        /// appends a row, overwriting the oldest one when the buffer is full
+        void push_back(const value_type& value) { push_back_tuple(indices(), value); }
+
+        void push_back(value_type&& value) { push_back_tuple(indices(), std::move(value)); }
+
+        /// appends a row constructed from one argument per field. If a field constructor
+        /// throws the row is not added, a full buffer has lost its oldest row by then.
+        template<typename... Args>
+        void emplace_back(Args&&... args)
+        {
+            JM_CB_STATIC_ASSERT(sizeof...(Args) == sizeof...(Ts),
+                                "emplace_back takes one argument per field");
+
+            const size_type new_tail = wrapper_t::increment(_tail);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(full()))
+                pop_front();
+
+            construct(new_tail, std::forward<Args>(args)...);
+            _tail = static_cast<index_type>(new_tail);
+            ++_size;
+        }
+
+        void pop_front() JM_CB_NOEXCEPT
+        {
+            destroy(indices(), _head);
+            _head = static_cast<index_type>(wrapper_t::increment(_head));
+            --_size;
+        }
+
+        void pop_back() JM_CB_NOEXCEPT
+        {
+            destroy(indices(), _tail);
+            _tail = static_cast<index_type>(wrapper_t::decrement(_tail));
+            --_size;
+        }
+
+        /// removes the first n rows, n must not exceed size()
+        void pop_front(size_type n) JM_CB_NOEXCEPT
+        {
+            for(size_type i = 0, pos = _head; i < n; ++i, pos = wrapper_t::increment(pos))
+                destroy(indices(), pos);
+
+            _head = static_cast<index_type>(wrapper_t::add(_head, n));
+            _size = static_cast<index_type>(_size - n);
+        }
+
+        void clear() JM_CB_NOEXCEPT
+        {
+            pop_front(size());
+            reset_indices();
+        }
+
+        /// iterators
+        iterator begin() JM_CB_NOEXCEPT { return iterator(this, 0); }
+
+        const_iterator begin() const JM_CB_NOEXCEPT { return const_iterator(this, 0); }
+
+        const_iterator cbegin() const JM_CB_NOEXCEPT { return begin(); }
+
+        iterator end() JM_CB_NOEXCEPT { return iterator(this, size()); }
+
+        const_iterator end() const JM_CB_NOEXCEPT { return const_iterator(this, size()); }
+
+        const_iterator cend() const JM_CB_NOEXCEPT { return end(); }
+
+        reverse_iterator rbegin() JM_CB_NOEXCEPT { return reverse_iterator(end()); }
+
+        const_reverse_iterator rbegin() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() JM_CB_NOEXCEPT { return reverse_iterator(begin()); }
+
+        const_reverse_iterator rend() const JM_CB_NOEXCEPT
+        {
+            return const_reverse_iterator(begin());
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
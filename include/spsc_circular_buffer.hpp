@@ -0,0 +1,215 @@
+/*
+ * Copyright 2017 Justas Masiulis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JM_SPSC_CIRCULAR_BUFFER_HPP
+#define JM_SPSC_CIRCULAR_BUFFER_HPP
+
+#include "circular_buffer.hpp"
+
+#include <atomic>
+
+namespace jm {
+
+    /// lock free fixed capacity queue for exactly one producer and one consumer thread.
+    /// head and tail are free running counters kept on separate cache lines, each side
+    /// also keeps a cached copy of the opposite counter so that it only touches the
+    /// other side's cache line when the cached value says the queue is full / empty.
+    template<typename T, std::size_t N>
+    class spsc_circular_buffer {
+    public:
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+    private:
+        typedef detail::optional_storage<T> storage_type;
+
+        JM_CB_STATIC_ASSERT(N != 0, "spsc_circular_buffer requires N > 0");
+
+        // consumer side
+        alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<size_type> _head;
+        size_type _cached_tail;
+
+        // producer side
+        alignas(JM_CB_CACHE_LINE_SIZE) std::atomic<size_type> _tail;
+        size_type _cached_head;
+
+        alignas(JM_CB_CACHE_LINE_SIZE) storage_type _buffer[N];
+
+        static size_type index(size_type pos) noexcept { return pos % N; }
+
+        T* slot(size_type pos) noexcept { return JM_CB_ADDRESSOF(_buffer[index(pos)]._value); }
+
+        // number of slots the producer can fill, refreshing the cached head when the
+        // cached value does not leave room for want elements
+        size_type producer_free(size_type tail, size_type want) noexcept
+        {
+            size_type free = N - (tail - _cached_head);
+            if(free < want) {
+                _cached_head = _head.load(std::memory_order_acquire);
+                free         = N - (tail - _cached_head);
+            }
+
+            return free;
+        }
+
+        size_type consumer_available(size_type head, size_type want) noexcept
+        {
+            size_type available = _cached_tail - head;
+            if(available < want) {
+                _cached_tail = _tail.load(std::memory_order_acquire);
+                available    = _cached_tail - head;
+            }
+
+            return available;
+        }
+
+        template<class ContiguousIt>
+        void write_n(size_type tail, ContiguousIt first, size_type n, std::true_type) noexcept
+        {
+            const T*        src     = detail::cb_to_address(first);
+            const size_type idx     = index(tail);
+            const size_type first_n = (std::min)(n, N - idx);
+
+            std::memcpy(slot(tail), src, first_n * sizeof(T));
+            if(first_n != n)
+                std::memcpy(slot(0), src + first_n, (n - first_n) * sizeof(T));
+        }
+
+        template<class InputIt>
+        void write_n(size_type tail, InputIt first, size_type n, std::false_type)
+        {
+            for(size_type i = 0; i < n; ++i, ++first)
+                new(slot(tail + i)) T(*first);
+        }
+
+        template<class ContiguousIt>
+        void read_n(size_type head, ContiguousIt dst, size_type n, std::true_type) noexcept
+        {
+            T*              out     = detail::cb_to_address(dst);
+            const size_type idx     = index(head);
+            const size_type first_n = (std::min)(n, N - idx);
+
+            std::memcpy(out, slot(head), first_n * sizeof(T));
+            if(first_n != n)
+                std::memcpy(out + first_n, slot(0), (n - first_n) * sizeof(T));
+        }
+
+        template<class OutputIt>
+        void read_n(size_type head, OutputIt dst, size_type n, std::false_type)
+        {
+            for(size_type i = 0; i < n; ++i, ++dst) {
+                T* value = slot(head + i);
+                *dst     = std::move(*value);
+                value->~T();
+            }
+        }
+
+    public:
+        spsc_circular_buffer() noexcept : _head(0), _cached_tail(0), _tail(0), _cached_head(0)
+        {}
+
+        spsc_circular_buffer(const spsc_circular_buffer&) = delete;
+        spsc_circular_buffer& operator=(const spsc_circular_buffer&) = delete;
+
+        ~spsc_circular_buffer()
+        {
+            if(!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)) {
+                const size_type tail = _tail.load(std::memory_order_acquire);
+                for(size_type head = _head.load(std::memory_order_relaxed); head != tail; ++head)
+                    slot(head)->~T();
+            }
+        }
+
+        /// capacity, only approximate while the other thread is running
+        bool empty() const noexcept { return size() == 0; }
+
+        bool full() const noexcept { return size() == N; }
+
+        size_type size() const noexcept
+        {
+            const size_type head = _head.load(std::memory_order_acquire);
+            return _tail.load(std::memory_order_acquire) - head;
+        }
+
+        JM_CB_CONSTEXPR size_type max_size() const noexcept { return N; }
+
+        /// producer
+        template<typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            const size_type tail = _tail.load(std::memory_order_relaxed);
+            if(JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(producer_free(tail, 1) == 0))
+                return false;
+
+            new(slot(tail)) T(std::forward<Args>(args)...);
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_push(const value_type& value) { return try_emplace(value); }
+
+        bool try_push(value_type&& value) { return try_emplace(std::move(value)); }
+
+        /// pushes as many elements of [first, last) as fit and returns their count,
+        /// the elements are published to the consumer all at once
+        template<typename ForwardIt,
+                 typename std::enable_if<!std::is_integral<ForwardIt>::value, int>::type = 0>
+        size_type try_push(ForwardIt first, ForwardIt last)
+        {
+            const size_type tail = _tail.load(std::memory_order_relaxed);
+            const size_type want = static_cast<size_type>(std::distance(first, last));
+            const size_type n    = (std::min)(want, producer_free(tail, want));
+
+            write_n(tail, first, n, detail::cb_is_memcpyable<ForwardIt, T>());
+            _tail.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        /// consumer
+        bool try_pop(value_type& out)
+        {
+            const size_type head = _head.load(std::memory_order_relaxed);
+            if(consumer_available(head, 1) == 0)
+                return false;
+
+            T* value = slot(head);
+            out      = std::move(*value);
+            value->~T();
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// moves up to n elements into dst and returns their count
+        template<class OutputIt>
+        size_type try_pop(OutputIt dst, size_type n)
+        {
+            const size_type head = _head.load(std::memory_order_relaxed);
+            n                    = (std::min)(n, consumer_available(head, n));
+
+            read_n(head, dst, n, detail::cb_is_memcpyable<OutputIt, T>());
+            _head.store(head + n, std::memory_order_release);
+            return n;
+        }
+    };
+
+} // namespace jm
+
+#endif // include guard
@@ -0,0 +1,138 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <circular_buffer_algorithm.hpp>
+#include <dynamic_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <deque>
+#include <forward_list>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+template<class Buffer>
+static void check_algorithms(Buffer& cb)
+{
+    const std::vector<int> model(cb.begin(), cb.end());
+
+    int sum = 0;
+    jm::for_each(cb, [&](int v) { sum += v; });
+    REQUIRE(sum == std::accumulate(model.begin(), model.end(), 0));
+    REQUIRE(jm::accumulate(cb, 0) == sum);
+    const auto hash = [](unsigned a, int b) { return a * 31u + static_cast<unsigned>(b); };
+    REQUIRE(jm::accumulate(cb, 1u, hash) == std::accumulate(model.begin(), model.end(), 1u, hash));
+
+    std::vector<int> copied;
+    jm::copy(cb, std::back_inserter(copied));
+    REQUIRE(copied == model);
+
+    std::vector<int> raw(cb.size());
+    REQUIRE(jm::copy(cb, raw.data()) == raw.data() + raw.size());
+    REQUIRE(raw == model);
+
+    std::vector<int> doubled;
+    jm::transform(cb, std::back_inserter(doubled), [](int v) { return v * 2; });
+    for(std::size_t i = 0; i < model.size(); ++i)
+        REQUIRE(doubled[i] == model[i] * 2);
+
+    for(int v = -1; v < 25; ++v) {
+        const auto expected = std::find(cb.begin(), cb.end(), v);
+        REQUIRE(jm::find(cb, v) == expected);
+        REQUIRE(jm::find_if(cb, [v](int x) { return x == v; }) == expected);
+        REQUIRE(jm::count(cb, v) ==
+                static_cast<std::size_t>(std::count(model.begin(), model.end(), v)));
+    }
+    REQUIRE(jm::count_if(cb, [](int v) { return v % 2 == 0; }) ==
+            static_cast<std::size_t>(
+                std::count_if(model.begin(), model.end(), [](int v) { return v % 2 == 0; })));
+
+    REQUIRE(jm::equal(cb, model.begin()));
+    REQUIRE(jm::equal(cb, model.begin(), model.end()));
+    if(!model.empty()) {
+        REQUIRE_FALSE(jm::equal(cb, model.begin(), model.end() - 1));
+
+        std::vector<int> changed = model;
+        changed.back() += 1;
+        REQUIRE_FALSE(jm::equal(cb, changed.begin()));
+    }
+
+    const std::forward_list<int> list(model.begin(), model.end());
+    REQUIRE(jm::equal(cb, list.begin(), list.end()));
+}
+
+TEST_CASE("segmented algorithms")
+{
+    jm::circular_buffer<int, 8> cb;
+    check_algorithms(cb);
+
+    for(int i = 0; i < 20; ++i) {
+        cb.push_back(i % 7);
+        check_algorithms(cb);
+
+        const auto& ccb = cb;
+        REQUIRE(jm::find(ccb, i % 7) == std::find(ccb.begin(), ccb.end(), i % 7));
+    }
+
+    jm::dynamic_circular_buffer<int> dcb(5);
+    for(int i = 0; i < 12; ++i) {
+        dcb.push_front(i);
+        check_algorithms(dcb);
+    }
+}
+
+TEST_CASE("segmented algorithms with input iterators")
+{
+    jm::circular_buffer<int, 4> cb{ 1, 2, 3, 4 };
+    cb.push_back(5);
+
+    std::istringstream         in("2 3 4 5");
+    std::istream_iterator<int> first(in);
+    REQUIRE(jm::equal(cb, first));
+
+    jm::for_each(cb, [](int& v) { v *= 10; });
+    REQUIRE(cb.front() == 20);
+    REQUIRE(cb.back() == 50);
+}
+
+namespace std_calls {
+
+    using namespace std;
+
+    // unqualified calls on buffer iterators find the jm overloads through ADL, they
+    // must drop out so that the std algorithms are picked
+    static bool equal_and_sum(const jm::circular_buffer<int, 4>& a,
+                              const jm::circular_buffer<int, 4>& b,
+                              int&                               sum)
+    {
+        sum = accumulate(a.begin(), a.end(), 0);
+        return equal(a.begin(), a.end(), b.begin());
+    }
+
+    static void search(jm::circular_buffer<int, 4>& a)
+    {
+        REQUIRE(count(a.begin(), a.end(), 2) == 1);
+        REQUIRE(*find(a.begin(), a.end(), 3) == 3);
+
+        std::vector<int> out;
+        copy(a.begin(), a.end(), back_inserter(out));
+        REQUIRE(out.size() == 4);
+        for_each(a.begin(), a.end(), [](int& v) { v += 1; });
+    }
+
+} // namespace std_calls
+
+TEST_CASE("segmented algorithms leave iterator calls to std")
+{
+    jm::circular_buffer<int, 4> a{ 1, 2, 3, 4 };
+    jm::circular_buffer<int, 4> b{ 1, 2, 3, 4 };
+
+    int sum = 0;
+    REQUIRE(std_calls::equal_and_sum(a, b, sum));
+    REQUIRE(sum == 10);
+
+    b.push_back(5);
+    REQUIRE_FALSE(std_calls::equal_and_sum(a, b, sum));
+
+    std_calls::search(a);
+    REQUIRE(a.front() == 2);
+}
@@ -0,0 +1,129 @@
+// built as its own C++20 executable, see CMakeLists.txt
+#define CATCH_CONFIG_MAIN
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <async_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    template<class Queue>
+    jm::async_task produce(Queue& q, int first, int count, std::vector<std::string>& log)
+    {
+        for(int i = first; i < first + count; ++i) {
+            co_await q.push(i);
+            log.push_back("pushed " + std::to_string(i));
+        }
+    }
+
+    template<class Queue>
+    jm::async_task consume(Queue& q, int count, std::vector<std::string>& log)
+    {
+        for(int i = 0; i < count; ++i) {
+            const int v = co_await q.pop();
+            log.push_back("popped " + std::to_string(v));
+        }
+    }
+
+} // namespace
+
+TEST_CASE("async queue hands values to a waiting consumer")
+{
+    jm::single_thread_executor        ex;
+    jm::async_circular_buffer<int, 2> q;
+    std::vector<std::string>          log;
+
+    ex.spawn(consume(q, 2, log));
+    ex.spawn(produce(q, 1, 2, log));
+    REQUIRE(ex.run() == 2);
+
+    // the consumer is resumed inside the push, before the producer continues
+    REQUIRE(log ==
+            (std::vector<std::string>{ "popped 1", "pushed 1", "popped 2", "pushed 2" }));
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("async queue applies back pressure to producers")
+{
+    jm::single_thread_executor        ex;
+    jm::async_circular_buffer<int, 2> q;
+    std::vector<std::string>          log;
+
+    ex.spawn(produce(q, 1, 4, log));
+    REQUIRE(ex.run() == 1);
+    REQUIRE(q.full());
+    REQUIRE(log == (std::vector<std::string>{ "pushed 1", "pushed 2" }));
+
+    // popping refills the slot from the parked producer and resumes it, which
+    // parks again on the next push
+    int v = 0;
+    REQUIRE(q.try_pop(v));
+    REQUIRE(v == 1);
+    REQUIRE(q.full());
+    REQUIRE(log.back() == "pushed 3");
+
+    // the pop of 2 resumes the producer inline, before the consumer logs the value
+    ex.spawn(consume(q, 3, log));
+    ex.run();
+    REQUIRE(q.empty());
+    REQUIRE(log ==
+            (std::vector<std::string>{ "pushed 1",
+                                       "pushed 2",
+                                       "pushed 3",
+                                       "pushed 4",
+                                       "popped 2",
+                                       "popped 3",
+                                       "popped 4" }));
+}
+
+TEST_CASE("async queue with several producers and consumers")
+{
+    jm::single_thread_executor                         ex;
+    jm::async_circular_buffer<std::unique_ptr<int>, 3> q;
+    std::vector<int>                                   received;
+
+    auto producer = [&](int first) -> jm::async_task {
+        for(int i = first; i < first + 100; ++i) {
+            co_await q.push(std::make_unique<int>(i));
+            if(i % 7 == 0)
+                co_await ex.schedule();
+        }
+    };
+
+    auto consumer = [&]() -> jm::async_task {
+        for(int i = 0; i < 100; ++i) {
+            std::unique_ptr<int> p = co_await q.pop();
+            received.push_back(*p);
+            if(i % 5 == 0)
+                co_await ex.schedule();
+        }
+    };
+
+    ex.spawn(consumer());
+    ex.spawn(producer(0));
+    ex.spawn(consumer());
+    ex.spawn(producer(1000));
+    ex.run();
+
+    REQUIRE(q.empty());
+    REQUIRE(received.size() == 200);
+
+    std::vector<int> firsts, seconds;
+    for(int v : received)
+        (v < 1000 ? firsts : seconds).push_back(v);
+    REQUIRE(firsts.size() == 100);
+    REQUIRE(seconds.size() == 100);
+    for(int i = 0; i < 100; ++i) {
+        REQUIRE(firsts[i] == i);
+        REQUIRE(seconds[i] == 1000 + i);
+    }
+}
+
+#elif defined(JM_CB_TEST_COROUTINES)
+#error "async.cpp was built with the C++20 flags but does not see coroutines"
+#endif
@@ -0,0 +1,175 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+// go to sleep right away so the tests exercise the wake ups and not the spinning
+#define JM_CB_SPIN_COUNT 0
+#include <blocking_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_CASE("blocking queue single threaded")
+{
+    jm::blocking_circular_buffer<int, 2> q;
+    REQUIRE(q.empty());
+    REQUIRE(q.max_size() == 2);
+
+    q.push(1);
+    REQUIRE(q.try_push(2));
+    REQUIRE_FALSE(q.try_push(3));
+
+    int v = 0;
+    q.pop(v);
+    REQUIRE(v == 1);
+    REQUIRE(q.try_pop(v));
+    REQUIRE(v == 2);
+    REQUIRE_FALSE(q.try_pop(v));
+}
+
+TEST_CASE("blocking queue timed operations time out")
+{
+    jm::blocking_circular_buffer<std::unique_ptr<int>, 2> q;
+
+    std::unique_ptr<int> out;
+    auto                 start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(q.try_pop_for(out, std::chrono::milliseconds(20)));
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+    REQUIRE(q.try_push_for(std::unique_ptr<int>(new int(1)), std::chrono::milliseconds(20)));
+    REQUIRE(q.try_push(std::unique_ptr<int>(new int(2))));
+
+    // a rejected element is not moved from
+    std::unique_ptr<int> third(new int(3));
+    start = std::chrono::steady_clock::now();
+    REQUIRE_FALSE(q.try_push_for(std::move(third), std::chrono::milliseconds(20)));
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    REQUIRE(third);
+
+    REQUIRE(q.try_pop_for(out, std::chrono::seconds(1)));
+    REQUIRE(*out == 1);
+}
+
+TEST_CASE("blocking queue wakes sleeping threads")
+{
+    jm::blocking_circular_buffer<int, 2> q;
+
+    SECTION("consumer")
+    {
+        int         v = 0;
+        std::thread consumer([&] { q.pop(v); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        q.push(42);
+        consumer.join();
+        REQUIRE(v == 42);
+    }
+
+    SECTION("timed producer")
+    {
+        q.push(1);
+        q.push(2);
+        bool        pushed = false;
+        std::thread producer([&] { pushed = q.try_push_for(3, std::chrono::seconds(10)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        int v = 0;
+        q.pop(v);
+        producer.join();
+        REQUIRE(pushed);
+        REQUIRE(v == 1);
+        q.pop(v);
+        q.pop(v);
+        REQUIRE(v == 3);
+    }
+}
+
+TEST_CASE("blocking queue with several producers and consumers")
+{
+    const unsigned per_producer = 20000;
+    const unsigned producers    = 3;
+    const unsigned consumers    = 3;
+
+    jm::blocking_circular_buffer<std::uint64_t, 8> q;
+    std::atomic<std::uint64_t>                     sum(0);
+    std::vector<std::thread>                       threads;
+
+    for(unsigned p = 0; p < producers; ++p)
+        threads.emplace_back([&] {
+            for(std::uint64_t i = 1; i <= per_producer; ++i)
+                q.push(i);
+        });
+
+    for(unsigned c = 0; c < consumers; ++c)
+        threads.emplace_back([&] {
+            std::uint64_t v     = 0;
+            std::uint64_t local = 0;
+            for(unsigned i = 0; i < per_producer; ++i) {
+                q.pop(v);
+                local += v;
+            }
+            sum.fetch_add(local);
+        });
+
+    for(auto& t : threads)
+        t.join();
+
+    const std::uint64_t expected = producers * (std::uint64_t(per_producer) * (per_producer + 1) / 2);
+    REQUIRE(sum.load() == expected);
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("blocking queue does not lose wake ups")
+{
+    // a tiny queue keeps every thread going to sleep and waking up all the time, which
+    // is where a lost wake up shows as a hang. The watchdog turns the hang into a failure.
+    const unsigned rounds       = 50;
+    const unsigned per_producer = 2000;
+    const unsigned threads_each = 4;
+
+    for(unsigned round = 0; round < rounds; ++round) {
+        jm::blocking_circular_buffer<unsigned, 2> q;
+        std::atomic<unsigned>                     got(0);
+        std::atomic<unsigned>                     finished(0);
+        std::vector<std::thread>                  threads;
+
+        for(unsigned p = 0; p < threads_each; ++p)
+            threads.emplace_back([&] {
+                for(unsigned i = 0; i < per_producer; ++i)
+                    q.push(i);
+                finished.fetch_add(1);
+            });
+
+        for(unsigned c = 0; c < threads_each; ++c)
+            threads.emplace_back([&] {
+                unsigned v = 0;
+                for(unsigned i = 0; i < per_producer; ++i) {
+                    q.pop(v);
+                    got.fetch_add(1, std::memory_order_relaxed);
+                }
+                finished.fetch_add(1);
+            });
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while(finished.load() != 2 * threads_each) {
+            if(std::chrono::steady_clock::now() > deadline) {
+                std::fprintf(stderr,
+                             "blocking queue hung in round %u with got=%u size=%u\n",
+                             round,
+                             got.load(),
+                             static_cast<unsigned>(q.size()));
+                std::abort();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        for(auto& t : threads)
+            t.join();
+
+        REQUIRE(got.load() == threads_each * per_producer);
+        REQUIRE(q.empty());
+    }
+}
@@ -0,0 +1,326 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <dynamic_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define JM_CB_TEST_PMR
+#endif
+#endif
+
+template<class Buffer, class Model>
+static void require_same(const Buffer& cb, const Model& model)
+{
+    REQUIRE(cb.size() == model.size());
+    REQUIRE(std::equal(cb.begin(), cb.end(), model.begin()));
+    REQUIRE(std::equal(cb.rbegin(), cb.rend(), model.rbegin()));
+    if(!model.empty()) {
+        REQUIRE(cb.front() == model.front());
+        REQUIRE(cb.back() == model.back());
+    }
+}
+
+TEST_CASE("dynamic circular buffer matches a deque model")
+{
+    for(std::size_t capacity : {1u, 2u, 3u, 7u, 8u}) {
+        jm::dynamic_circular_buffer<int> cb(capacity);
+        std::deque<int>                  model;
+        REQUIRE(cb.capacity() == capacity);
+        REQUIRE(cb.empty());
+
+        for(int i = 0; i < 50; ++i) {
+            switch(i % 5) {
+            case 0:
+            case 1:
+                cb.push_back(i);
+                model.push_back(i);
+                if(model.size() > capacity)
+                    model.pop_front();
+                break;
+            case 2:
+                cb.push_front(i);
+                model.push_front(i);
+                if(model.size() > capacity)
+                    model.pop_back();
+                break;
+            case 3:
+                cb.emplace_back(i);
+                model.push_back(i);
+                if(model.size() > capacity)
+                    model.pop_front();
+                break;
+            default:
+                if(!model.empty()) {
+                    cb.pop_front();
+                    model.pop_front();
+                }
+            }
+
+            require_same(cb, model);
+            for(std::size_t j = 0; j < model.size(); ++j)
+                REQUIRE(cb[j] == model[j]);
+            REQUIRE(cb.array_one().second + cb.array_two().second == cb.size());
+        }
+    }
+}
+
+TEST_CASE("dynamic circular buffer without capacity")
+{
+    jm::dynamic_circular_buffer<std::string> cb;
+    REQUIRE(cb.capacity() == 0);
+    REQUIRE(cb.data() == nullptr);
+    REQUIRE(cb.begin() == cb.end());
+
+    cb.push_back("a");
+    cb.emplace_front("b");
+    REQUIRE(cb.empty());
+    REQUIRE_FALSE(cb.try_push_back("a"));
+    REQUIRE_FALSE(cb.try_emplace_front("b"));
+
+    cb.reserve(2);
+    cb.push_back("a");
+    cb.push_back("b");
+    cb.push_back("c");
+    REQUIRE(cb.front() == "b");
+    REQUIRE(cb.back() == "c");
+
+    cb.pop_front();
+    REQUIRE(cb.try_push_front("d"));
+    REQUIRE_FALSE(cb.try_push_back("e"));
+    REQUIRE(cb.front() == "d");
+    REQUIRE(cb.back() == "c");
+}
+
+TEST_CASE("dynamic circular buffer set_capacity relinearizes")
+{
+    jm::dynamic_circular_buffer<int> cb(4);
+    for(int i = 0; i < 6; ++i)
+        cb.push_back(i);
+    REQUIRE(cb.array_two().second != 0);
+
+    cb.reserve(8);
+    REQUIRE(cb.capacity() == 8);
+    REQUIRE(cb.array_one().first == cb.data());
+    REQUIRE(cb.array_one().second == 4);
+    require_same(cb, std::vector<int>{ 2, 3, 4, 5 });
+
+    cb.reserve(2);
+    REQUIRE(cb.capacity() == 8);
+
+    cb.set_capacity(3);
+    require_same(cb, std::vector<int>{ 3, 4, 5 });
+
+    cb.pop_back();
+    cb.shrink_to_fit();
+    REQUIRE(cb.capacity() == 2);
+    REQUIRE(cb.full());
+    require_same(cb, std::vector<int>{ 3, 4 });
+
+    cb.set_capacity(0);
+    REQUIRE(cb.empty());
+    REQUIRE(cb.data() == nullptr);
+}
+
+TEST_CASE("dynamic circular buffer set_capacity with non trivial type")
+{
+    jm::dynamic_circular_buffer<std::string> cb(3);
+    for(int i = 0; i < 5; ++i)
+        cb.push_back(std::string(30, static_cast<char>('a' + i)));
+
+    cb.set_capacity(5);
+    cb.push_back("x");
+    REQUIRE(cb.size() == 4);
+    REQUIRE(cb[0] == std::string(30, 'c'));
+    REQUIRE(cb[2] == std::string(30, 'e'));
+    REQUIRE(cb.back() == "x");
+
+    cb.set_capacity(1);
+    REQUIRE(cb.front() == "x");
+}
+
+struct throwing_copy {
+    static int copies_left;
+    int        value;
+
+    throwing_copy(int v) : value(v) {}
+    throwing_copy(const throwing_copy& other) : value(other.value)
+    {
+        if(copies_left-- == 0)
+            throw std::runtime_error("copy");
+    }
+    throwing_copy& operator=(const throwing_copy&) = default;
+};
+
+int throwing_copy::copies_left = 0;
+
+TEST_CASE("dynamic circular buffer set_capacity strong guarantee")
+{
+    jm::dynamic_circular_buffer<throwing_copy> cb(3);
+    for(int i = 0; i < 3; ++i)
+        cb.emplace_back(i);
+
+    throwing_copy::copies_left = 1;
+    REQUIRE_THROWS_AS(cb.set_capacity(6), std::runtime_error);
+    REQUIRE(cb.capacity() == 3);
+    REQUIRE(cb.size() == 3);
+    for(int i = 0; i < 3; ++i)
+        REQUIRE(cb[i].value == i);
+}
+
+TEST_CASE("dynamic circular buffer copy, move and swap")
+{
+    jm::dynamic_circular_buffer<std::string> a{ "a", "b", "c" };
+    a.push_back("d");
+
+    jm::dynamic_circular_buffer<std::string> b(a);
+    REQUIRE(b.capacity() == 3);
+    require_same(b, std::vector<std::string>{ "b", "c", "d" });
+
+    const std::string* storage = a.data();
+    jm::dynamic_circular_buffer<std::string> c(std::move(a));
+    REQUIRE(c.data() == storage);
+    REQUIRE(a.capacity() == 0);
+    REQUIRE(a.empty());
+
+    jm::dynamic_circular_buffer<std::string> d(10);
+    d = std::move(c);
+    REQUIRE(d.data() == storage);
+    REQUIRE(d.capacity() == 3);
+
+    jm::dynamic_circular_buffer<std::string> e(1);
+    e = b;
+    REQUIRE(e.capacity() == 3);
+    require_same(e, b);
+
+    jm::dynamic_circular_buffer<std::string> f(5, 2, "f");
+    swap(e, f);
+    REQUIRE(e.capacity() == 5);
+    require_same(e, std::vector<std::string>{ "f", "f" });
+    require_same(f, b);
+
+    REQUIRE_THROWS_AS((jm::dynamic_circular_buffer<int>(2, 3, 0)), std::out_of_range);
+}
+
+TEST_CASE("dynamic circular buffer ranges and read")
+{
+    jm::dynamic_circular_buffer<int> cb(5);
+    const int                        src[] = { 0, 1, 2, 3, 4, 5, 6 };
+
+    cb.push_back(src, src + 3);
+    cb.push_back(src + 3, src + 7);
+    require_same(cb, std::vector<int>{ 2, 3, 4, 5, 6 });
+
+    cb.push_front(src, src + 2);
+    require_same(cb, std::vector<int>{ 0, 1, 2, 3, 4 });
+
+    int out[3];
+    REQUIRE(cb.read(out, 3) == 3);
+    REQUIRE(out[2] == 2);
+    require_same(cb, std::vector<int>{ 3, 4 });
+
+    cb.assign(7, 9);
+    REQUIRE(cb.size() == 5);
+    REQUIRE(cb.at(4) == 9);
+    REQUIRE_THROWS_AS(cb.at(5), std::out_of_range);
+
+    auto it = cb.begin();
+    REQUIRE(cb.end() - it == 5);
+    REQUIRE(it[4] == 9);
+}
+
+#ifdef JM_CB_TEST_PMR
+
+TEST_CASE("dynamic circular buffer reserve, commit, peek and consume")
+{
+    jm::dynamic_circular_buffer<std::string> cb(4);
+    cb.push_back("a");
+    cb.push_back("b");
+    cb.push_back("c");
+    cb.pop_front(2);
+
+    auto slots = cb.reserve_back(8);
+    REQUIRE(slots.first.second == 1);
+    REQUIRE(slots.second.second == 2);
+    new(slots.first.first) std::string("d");
+    new(slots.second.first) std::string("e");
+    cb.commit_back(2);
+    require_same(cb, std::vector<std::string>{ "c", "d", "e" });
+
+    auto ready = cb.peek_front(3);
+    REQUIRE(ready.first.second == 2);
+    REQUIRE(ready.second.second == 1);
+    REQUIRE(ready.second.first[0] == "e");
+
+    cb.consume_front(2);
+    require_same(cb, std::vector<std::string>{ "e" });
+
+    jm::dynamic_circular_buffer<int> empty;
+    REQUIRE(empty.reserve_back(4).first.second == 0);
+    REQUIRE(empty.peek_front(4).second.second == 0);
+}
+
+TEST_CASE("dynamic circular buffer with a polymorphic allocator")
+{
+    unsigned char                       arena[1024];
+    std::pmr::monotonic_buffer_resource resource(
+        arena, sizeof(arena), std::pmr::null_memory_resource());
+
+    typedef jm::dynamic_circular_buffer<int, std::pmr::polymorphic_allocator<int>> pmr_buffer;
+
+    pmr_buffer cb(16, &resource);
+    for(int i = 0; i < 40; ++i)
+        cb.push_back(i);
+    REQUIRE(cb.front() == 24);
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(cb.data());
+    REQUIRE(data >= arena);
+    REQUIRE(data < arena + sizeof(arena));
+
+    cb.set_capacity(32);
+    REQUIRE(cb.get_allocator().resource() == &resource);
+    REQUIRE(cb.front() == 24);
+    REQUIRE(cb.back() == 39);
+
+    // the allocators compare equal so the storage is taken over
+    pmr_buffer other(4, &resource);
+    const int* storage = cb.data();
+    other              = std::move(cb);
+    REQUIRE(other.data() == storage);
+
+    // different resources, the elements are moved one by one
+    std::pmr::unsynchronized_pool_resource pool;
+    pmr_buffer                             third(2, &pool);
+    third = std::move(other);
+    REQUIRE(third.get_allocator().resource() == &pool);
+    REQUIRE(third.size() == 16);
+    REQUIRE(third.front() == 24);
+}
+
+#endif
+
+#if defined(__cpp_aligned_new)
+
+TEST_CASE("dynamic circular buffer with over aligned elements")
+{
+    struct alignas(64) wide {
+        int value;
+    };
+
+    jm::dynamic_circular_buffer<wide> cb(3);
+    for(int i = 0; i < 5; ++i)
+        cb.push_back(wide{ i });
+
+    for(const auto& element : cb)
+        REQUIRE(reinterpret_cast<std::uintptr_t>(&element) % 64 == 0);
+    REQUIRE(cb.front().value == 2);
+}
+
+#endif
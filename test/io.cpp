@@ -0,0 +1,91 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <circular_buffer_io.hpp>
+#include <dynamic_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <string>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+    struct fd_pair {
+        int fds[2];
+
+        ~fd_pair()
+        {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+    };
+
+    template<class Buffer>
+    std::string contents(const Buffer& cb)
+    {
+        return std::string(cb.begin(), cb.end());
+    }
+
+} // namespace
+
+TEST_CASE("read_from_fd and write_to_fd across the wrap with a pipe")
+{
+    fd_pair p;
+    REQUIRE(::pipe(p.fds) == 0);
+
+    jm::circular_buffer<char, 8> cb;
+    for(char c : std::string("xxxxxx"))
+        cb.push_back(c);
+    cb.pop_front(6);
+
+    REQUIRE(::write(p.fds[1], "abcdefghij", 10) == 10);
+
+    // the free space wraps, both segments are filled by one readv
+    REQUIRE(jm::read_from_fd(cb, p.fds[0]) == 8);
+    REQUIRE(cb.full());
+    REQUIRE(contents(cb) == "abcdefgh");
+    REQUIRE(cb.array_two().second == 6);
+
+    REQUIRE(jm::read_from_fd(cb, p.fds[0]) == 0);
+
+    REQUIRE(jm::write_to_fd(cb, p.fds[1], 5) == 5);
+    REQUIRE(contents(cb) == "fgh");
+    REQUIRE(jm::write_to_fd(cb, p.fds[1]) == 3);
+    REQUIRE(cb.empty());
+    REQUIRE(jm::write_to_fd(cb, p.fds[1]) == 0);
+
+    char out[16] = {};
+    REQUIRE(::read(p.fds[0], out, sizeof(out)) == 10);
+    REQUIRE(std::string(out, 10) == "ijabcdefgh");
+}
+
+TEST_CASE("read_from_fd with a partial read and EAGAIN on a socketpair")
+{
+    fd_pair s;
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, s.fds) == 0);
+    REQUIRE(::fcntl(s.fds[0], F_SETFL, ::fcntl(s.fds[0], F_GETFL) | O_NONBLOCK) == 0);
+
+    jm::dynamic_circular_buffer<char> cb(16);
+    REQUIRE(jm::read_from_fd(cb, s.fds[0]) == -1);
+    REQUIRE((errno == EAGAIN || errno == EWOULDBLOCK));
+    REQUIRE(cb.empty());
+
+    REQUIRE(::write(s.fds[1], "hello", 5) == 5);
+    REQUIRE(jm::read_from_fd(cb, s.fds[0], 3) == 3);
+    REQUIRE(jm::read_from_fd(cb, s.fds[0]) == 2);
+    REQUIRE(contents(cb) == "hello");
+
+    REQUIRE(jm::write_to_fd(cb, s.fds[0]) == 5);
+    char out[8];
+    REQUIRE(::read(s.fds[1], out, sizeof(out)) == 5);
+    REQUIRE(std::string(out, 5) == "hello");
+
+    ::shutdown(s.fds[1], SHUT_WR);
+    REQUIRE(jm::read_from_fd(cb, s.fds[0]) == 0);
+    REQUIRE(cb.empty());
+}
+
+#endif
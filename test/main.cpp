@@ -6,6 +6,12 @@
 #include <numeric>
 #include <vector>
 #include <atomic>
+#include <deque>
+#include <list>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <memory>
 
 std::uint64_t num_constructions = 0;
 std::uint64_t num_deletions     = 0;
@@ -426,3 +432,712 @@ TEST_CASE("cb_iterator complies to InputIterator")
     cbt::const_iterator non_c_it = it;
     non_c_it                     = it;
 }
+
+template<class Index, std::size_t N>
+void check_index_policy()
+{
+    jm::circular_buffer<int, N, Index> cb;
+    std::deque<int>                    model;
+
+    for(int i = 0; i < 200; ++i) {
+        switch(i % 7) {
+        case 0:
+        case 1:
+        case 2: cb.push_back(i); model.push_back(i); break;
+        case 3: cb.push_front(i); model.push_front(i); break;
+        case 4:
+            if(!model.empty()) {
+                cb.pop_front();
+                model.pop_front();
+            }
+            break;
+        case 5:
+            if(!model.empty()) {
+                cb.pop_back();
+                model.pop_back();
+            }
+            break;
+        case 6: cb.emplace_back(i); model.push_back(i); break;
+        }
+
+        while(model.size() > N)
+            (i % 7 == 3) ? model.pop_back() : model.pop_front();
+
+        REQUIRE(cb.size() == model.size());
+        REQUIRE(cb.full() == (model.size() == N));
+        REQUIRE(std::equal(model.begin(), model.end(), cb.begin()));
+        REQUIRE(std::distance(cb.begin(), cb.end()) ==
+                static_cast<std::ptrdiff_t>(model.size()));
+        if(!model.empty()) {
+            REQUIRE(cb.front() == model.front());
+            REQUIRE(cb.back() == model.back());
+        }
+    }
+
+    cb.clear();
+    REQUIRE(cb.empty());
+    REQUIRE(cb.begin() == cb.end());
+}
+
+TEST_CASE("index policies")
+{
+    check_index_policy<jm::modulo_index, 8>();
+    check_index_policy<jm::modulo_index, 5>();
+    check_index_policy<jm::mask_index, 8>();
+    check_index_policy<jm::branchless_index, 8>();
+    check_index_policy<jm::branchless_index, 5>();
+    check_index_policy<jm::branchless_index, 1>();
+    check_index_policy<jm::counter_index, 8>();
+    check_index_policy<jm::counter_index, 1>();
+
+    static_assert(sizeof(jm::circular_buffer<char, 16, jm::counter_index>) <
+                      sizeof(jm::circular_buffer<char, 16>),
+                  "counter_index should not store the size");
+}
+
+TEST_CASE("compact index types")
+{
+    static_assert(sizeof(jm::circular_buffer<std::uint8_t, 16>) == 16 + 3,
+                  "N <= 255 should use one byte per index");
+    static_assert(sizeof(jm::circular_buffer<std::uint8_t, 16, jm::counter_index>) == 16 + 2,
+                  "counter_index should only keep two one byte counters");
+    static_assert(sizeof(jm::circular_buffer<std::uint32_t, 256>) == 1024 + 3 * 4,
+                  "larger N should use four bytes per index");
+    static_assert(std::is_same<jm::circular_buffer<char, 16>::size_type, std::size_t>::value,
+                  "the public size_type stays std::size_t");
+
+    // the one byte counters wrap many times around 256
+    jm::circular_buffer<int, 128, jm::counter_index> counted;
+    jm::circular_buffer<int, 255, jm::branchless_index> widest;
+    for(int i = 0; i < 1000; ++i) {
+        counted.push_back(i);
+        widest.push_back(i);
+        if(i % 3 == 0) {
+            counted.pop_front();
+            widest.pop_front();
+        }
+    }
+
+    REQUIRE(counted.size() == 127);
+    REQUIRE(counted.front() == 873);
+    REQUIRE(counted.back() == 999);
+    REQUIRE(counted[100] == 973);
+    REQUIRE(std::distance(counted.begin(), counted.end()) == 127);
+    REQUIRE(counted.end() - counted.begin() == 127);
+    REQUIRE(*(counted.begin() + 126) == 999);
+
+    REQUIRE(widest.size() == 254);
+    REQUIRE(widest.front() == 746);
+    REQUIRE(widest[100] == 846);
+
+    counted.pop_front(127);
+    REQUIRE(counted.empty());
+    REQUIRE(counted.begin() == counted.end());
+
+    for(int i = 0; i < 128; ++i)
+        counted.push_front(i);
+    REQUIRE(counted.full());
+    REQUIRE(counted.size() == 128);
+    REQUIRE(counted.back() == 0);
+}
+
+TEST_CASE("random access iterators")
+{
+    static_assert(std::is_same<jm::circular_buffer<int, 4>::iterator::iterator_category,
+                               std::random_access_iterator_tag>::value,
+                  "cb_iterator is not random access");
+
+    // wrapped so that the logical sequence crosses the end of the storage
+    jm::circular_buffer<int, 16, jm::branchless_index> cb;
+    for(int i = 0; i < 16 + 5; ++i)
+        cb.push_back((i * 7) % 16);
+
+    auto first = cb.begin();
+    auto last  = cb.end();
+    REQUIRE(last - first == 16);
+    REQUIRE(std::distance(first, last) == 16);
+    REQUIRE(first < last);
+    REQUIRE(last > first);
+    REQUIRE(first <= first);
+    REQUIRE(first + 16 == last);
+    REQUIRE(last - 16 == first);
+    REQUIRE(16 + first == last);
+
+    for(std::size_t i = 0; i < cb.size(); ++i) {
+        REQUIRE(first[static_cast<std::ptrdiff_t>(i)] == cb[i]);
+        REQUIRE(*(first + static_cast<std::ptrdiff_t>(i)) == cb.at(i));
+    }
+
+    auto it = first;
+    std::advance(it, 9);
+    REQUIRE(*it == cb[9]);
+    it -= 4;
+    REQUIRE(*it == cb[5]);
+    REQUIRE(it - first == 5);
+    REQUIRE(first - it == -5);
+
+    std::sort(cb.begin(), cb.end());
+    REQUIRE(std::is_sorted(cb.begin(), cb.end()));
+    for(int i = 0; i < 16; ++i) {
+        REQUIRE(cb[static_cast<std::size_t>(i)] == i);
+        REQUIRE(*std::lower_bound(cb.cbegin(), cb.cend(), i) == i);
+    }
+
+    std::reverse(cb.begin(), cb.end());
+    std::nth_element(cb.begin(), cb.begin() + 8, cb.end());
+    REQUIRE(cb[8] == 8);
+
+    std::sort(cb.begin(), cb.end());
+    REQUIRE(std::equal(cb.rbegin(), cb.rend(), inc_vec.rend() - 16));
+    REQUIRE(*cb.rbegin() == 15);
+    REQUIRE(cb.rend() - cb.rbegin() == 16);
+}
+
+TEST_CASE("at")
+{
+    auto cb = gen_filled_cb(10);
+    REQUIRE(cb.at(0) == 0);
+    REQUIRE(cb.at(9) == 9);
+    REQUIRE_THROWS_AS(cb.at(10), std::out_of_range);
+
+    const auto& ccb = cb;
+    REQUIRE(ccb.at(3) == 3);
+    REQUIRE_THROWS_AS(ccb.at(16), std::out_of_range);
+}
+
+template<class Index>
+void check_array_ranges()
+{
+    jm::circular_buffer<int, 8, Index> cb;
+
+    for(int i = 0; i < 20; ++i) {
+        const auto one = cb.array_one();
+        const auto two = cb.array_two();
+        REQUIRE(one.second + two.second == cb.size());
+
+        std::vector<int> joined(one.first, one.first + one.second);
+        joined.insert(joined.end(), two.first, two.first + two.second);
+        REQUIRE(std::equal(joined.begin(), joined.end(), cb.begin()));
+        if(two.second != 0)
+            REQUIRE(one.first + one.second == cb.data() + 8);
+
+        const auto free_one = cb.free_array_one();
+        const auto free_two = cb.free_array_two();
+        REQUIRE(free_one.second + free_two.second == 8 - cb.size());
+        if(free_one.second != 0 && !cb.empty())
+            REQUIRE(free_one.first == cb.data() + (&cb.back() - cb.data() + 1) % 8);
+        if(free_two.second != 0)
+            REQUIRE(free_two.first == cb.data());
+
+        const auto& ccb = cb;
+        REQUIRE(ccb.array_one().first == one.first);
+        REQUIRE(ccb.array_two().second == two.second);
+
+        cb.push_back(i);
+        if(i % 3 == 0)
+            cb.pop_front();
+    }
+
+    cb.clear();
+    REQUIRE(cb.array_one().second == 0);
+    REQUIRE(cb.array_two().second == 0);
+    REQUIRE(cb.free_array_one().second == 8);
+}
+
+TEST_CASE("array ranges")
+{
+    check_array_ranges<jm::modulo_index>();
+    check_array_ranges<jm::counter_index>();
+}
+
+template<class Index, class Range>
+void check_range_push(const Range& range)
+{
+    jm::circular_buffer<int, 8, Index> cb;
+    std::deque<int>                    model;
+
+    int next = 1000;
+    for(std::size_t n = 0; n < 20; ++n) {
+        auto first = range.begin();
+        auto last  = first;
+        std::advance(last, n % (range.size() + 1));
+
+        if(n % 3 == 2) {
+            cb.push_front(first, last);
+            model.insert(model.begin(), first, last);
+            while(model.size() > 8)
+                model.pop_back();
+        }
+        else {
+            cb.push_back(first, last);
+            model.insert(model.end(), first, last);
+            while(model.size() > 8)
+                model.pop_front();
+        }
+
+        REQUIRE(cb.size() == model.size());
+        REQUIRE(std::equal(model.begin(), model.end(), cb.begin()));
+
+        // single element operations keep working after bulk ones
+        cb.push_back(next);
+        model.push_back(next++);
+        if(model.size() > 8)
+            model.pop_front();
+        REQUIRE(std::equal(model.begin(), model.end(), cb.begin()));
+    }
+}
+
+TEST_CASE("range push")
+{
+    const std::vector<int> v(inc_vec.begin(), inc_vec.begin() + 11);
+    const std::list<int>   l(v.begin(), v.end());
+
+    check_range_push<jm::modulo_index>(v);
+    check_range_push<jm::counter_index>(v);
+    check_range_push<jm::branchless_index>(l);
+    check_range_push<jm::counter_index>(l);
+
+    SECTION("pointers use the memcpy path and keep the last N elements")
+    {
+        jm::circular_buffer<std::uint8_t, 16> cb;
+        std::uint8_t                          bytes[40];
+        for(int i = 0; i < 40; ++i)
+            bytes[i] = static_cast<std::uint8_t>(i);
+
+        cb.push_back(bytes, bytes + 10);
+        cb.push_back(bytes + 10, bytes + 40);
+        REQUIRE(cb.size() == 16);
+        REQUIRE(cb.front() == 24);
+        REQUIRE(cb.back() == 39);
+
+        cb.push_front(bytes, bytes + 3);
+        REQUIRE(cb.front() == 0);
+        REQUIRE(cb[2] == 2);
+        REQUIRE(cb[3] == 24);
+        REQUIRE(cb.back() == 36);
+    }
+
+    SECTION("input iterators")
+    {
+        std::istringstream                 in("1 2 3 4 5 6");
+        jm::circular_buffer<int, 4>        cb;
+        cb.push_back(std::istream_iterator<int>(in), std::istream_iterator<int>());
+        REQUIRE(cb.front() == 3);
+        REQUIRE(cb.back() == 6);
+    }
+
+    SECTION("non trivial types")
+    {
+        {
+            std::vector<leak_checker>            src(5);
+            jm::circular_buffer<leak_checker, 3> cb;
+            cb.push_back(src.begin(), src.end());
+            cb.push_front(src.begin(), src.end());
+            cb.assign(src.begin(), src.begin() + 2);
+            REQUIRE(cb.size() == 2);
+        }
+        REQUIRE(num_constructions == num_deletions);
+    }
+}
+
+TEST_CASE("assign")
+{
+    jm::circular_buffer<int, 4> cb{ 9, 9 };
+
+    cb.assign(inc_vec.begin(), inc_vec.begin() + 6);
+    REQUIRE(cb.size() == 4);
+    REQUIRE(cb.front() == 2);
+
+    cb.assign(3, 7);
+    REQUIRE(cb.size() == 3);
+    REQUIRE(std::count(cb.begin(), cb.end(), 7) == 3);
+
+    cb.assign(10, 1);
+    REQUIRE(cb.size() == 4);
+
+    cb.assign({ 1, 2 });
+    REQUIRE(cb.size() == 2);
+    REQUIRE(cb.back() == 2);
+
+    const int arr[] = { 5, 6, 7 };
+    jm::circular_buffer<int, 4> from_ptr(arr, arr + 3);
+    REQUIRE(from_ptr.size() == 3);
+    REQUIRE(from_ptr.back() == 7);
+    REQUIRE_THROWS(void(jm::circular_buffer<int, 2>(arr, arr + 3)));
+}
+
+TEST_CASE("bulk pop")
+{
+    jm::circular_buffer<int, 8, jm::counter_index> cb;
+    std::deque<int>                                model;
+
+    for(int i = 0; i < 40; ++i) {
+        cb.push_back(i);
+        model.push_back(i);
+        if(model.size() > 8)
+            model.pop_front();
+
+        if(i % 5 == 4) {
+            const std::size_t n = model.size() / 2;
+            if(i % 2) {
+                cb.pop_front(n);
+                model.erase(model.begin(), model.begin() + static_cast<std::ptrdiff_t>(n));
+            }
+            else {
+                cb.pop_back(n);
+                model.erase(model.end() - static_cast<std::ptrdiff_t>(n), model.end());
+            }
+        }
+
+        REQUIRE(cb.size() == model.size());
+        REQUIRE(std::equal(model.begin(), model.end(), cb.begin()));
+    }
+
+    {
+        jm::circular_buffer<leak_checker, 4> lcb;
+        for(int i = 0; i < 6; ++i)
+            lcb.emplace_back();
+        lcb.pop_front(2);
+        lcb.pop_back(1);
+        REQUIRE(lcb.size() == 1);
+    }
+    REQUIRE(num_constructions == num_deletions);
+}
+
+TEST_CASE("read")
+{
+    jm::circular_buffer<int, 8> cb;
+    for(int i = 0; i < 13; ++i)
+        cb.push_back(i);
+
+    SECTION("into a pointer")
+    {
+        int out[16] = {};
+        REQUIRE(cb.read(out, 6) == 6);
+        for(int i = 0; i < 6; ++i)
+            REQUIRE(out[i] == 5 + i);
+        REQUIRE(cb.size() == 2);
+        REQUIRE(cb.front() == 11);
+
+        REQUIRE(cb.read(out, 16) == 2);
+        REQUIRE(out[1] == 12);
+        REQUIRE(cb.empty());
+        REQUIRE(cb.read(out, 1) == 0);
+    }
+
+    SECTION("into an output iterator")
+    {
+        std::vector<int> out;
+        REQUIRE(cb.read(std::back_inserter(out), 100) == 8);
+        REQUIRE(out == std::vector<int>(inc_vec.begin() + 5, inc_vec.begin() + 13));
+        REQUIRE(cb.empty());
+    }
+
+    SECTION("non trivial types are moved")
+    {
+        jm::circular_buffer<std::string, 4> scb;
+        for(int i = 0; i < 6; ++i)
+            scb.push_back(std::string(32, static_cast<char>('a' + i)));
+
+        std::string out[3];
+        REQUIRE(scb.read(out, 3) == 3);
+        REQUIRE(out[0] == std::string(32, 'c'));
+        REQUIRE(out[2] == std::string(32, 'e'));
+        REQUIRE(scb.size() == 1);
+        REQUIRE(scb.front() == std::string(32, 'f'));
+    }
+}
+
+TEST_CASE("trivial copy, move and swap")
+{
+    jm::circular_buffer<int, 8, jm::counter_index> cb;
+    for(int i = 0; i < 13; ++i)
+        cb.push_back(i);
+    REQUIRE(cb.array_two().second != 0);
+
+    auto copy = cb;
+    REQUIRE(copy.size() == 8);
+    REQUIRE(std::equal(cb.begin(), cb.end(), copy.begin()));
+    REQUIRE(copy.array_one().second == 8);
+
+    decltype(cb) moved;
+    moved.push_back(100);
+    moved = std::move(copy);
+    REQUIRE(std::equal(cb.begin(), cb.end(), moved.begin()));
+
+    decltype(cb) other{ 1, 2 };
+    swap(other, moved);
+    REQUIRE(other.size() == 8);
+    REQUIRE(std::equal(cb.begin(), cb.end(), other.begin()));
+    REQUIRE(moved.size() == 2);
+    REQUIRE(moved.back() == 2);
+
+    other = other;
+    REQUIRE(other.size() == 8);
+
+    other.clear();
+    REQUIRE(other.empty());
+    other.push_back(7);
+    REQUIRE(other.front() == 7);
+
+    jm::circular_buffer<std::string, 3> a{ "a", "b" };
+    jm::circular_buffer<std::string, 3> b{ "c" };
+    a.swap(b);
+    REQUIRE(a.size() == 1);
+    REQUIRE(a.front() == "c");
+    REQUIRE(b.back() == "b");
+}
+
+template<class Index>
+void check_trivial_swap()
+{
+    for(int a_head = 0; a_head < 8; ++a_head)
+        for(int a_size = 0; a_size <= 8; a_size += 3)
+            for(int b_head = 0; b_head < 8; b_head += 3)
+                for(int b_size = 0; b_size <= 8; b_size += 2) {
+                    jm::circular_buffer<int, 8, Index> a;
+                    jm::circular_buffer<int, 8, Index> b;
+                    for(int i = 0; i < a_head; ++i)
+                        a.push_back(-1);
+                    a.pop_front(static_cast<std::size_t>(a_head));
+                    for(int i = 0; i < b_head; ++i)
+                        b.push_back(-2);
+                    b.pop_front(static_cast<std::size_t>(b_head));
+                    for(int i = 0; i < a_size; ++i)
+                        a.push_back(100 + i);
+                    for(int i = 0; i < b_size; ++i)
+                        b.push_back(200 + i);
+
+                    const std::vector<int> a_model(a.begin(), a.end());
+                    const std::vector<int> b_model(b.begin(), b.end());
+                    swap(a, b);
+
+                    REQUIRE(std::vector<int>(a.begin(), a.end()) == b_model);
+                    REQUIRE(std::vector<int>(b.begin(), b.end()) == a_model);
+
+                    a.push_back(7);
+                    b.push_front(8);
+                    REQUIRE(a.back() == 7);
+                    REQUIRE(b.front() == 8);
+                }
+}
+
+TEST_CASE("trivial swap exchanges the live slots")
+{
+    check_trivial_swap<jm::modulo_index>();
+    check_trivial_swap<jm::counter_index>();
+
+    // slots that hold no element in either buffer are left alone
+    jm::circular_buffer<int, 8> a{ 1, 2, 3, 4, 5, 6 };
+    jm::circular_buffer<int, 8> b{ 9 };
+    a.pop_front(4);
+    swap(a, b);
+    REQUIRE(a.size() == 1);
+    REQUIRE(b.size() == 2);
+    REQUIRE(b.front() == 5);
+    REQUIRE(a.data()[0] == 9);
+    REQUIRE(b.data()[0] == 1);
+    REQUIRE(a.data()[1] == 2);
+    REQUIRE(a.data()[3] == 4);
+}
+
+TEST_CASE("statistics policy")
+{
+    REQUIRE(sizeof(jm::circular_buffer<int, 4>) ==
+            sizeof(jm::circular_buffer<int, 4, jm::modulo_index, jm::no_stats>));
+    REQUIRE(jm::circular_buffer<int, 4>().stats().pushes == 0);
+
+    jm::circular_buffer<int, 4, jm::modulo_index, jm::basic_stats> cb;
+    for(int i = 0; i < 6; ++i)
+        cb.push_back(i);
+    cb.push_front(-1);
+
+    auto stats = cb.stats();
+    REQUIRE(stats.pushes == 7);
+    REQUIRE(stats.overwrites_front == 2);
+    REQUIRE(stats.overwrites_back == 1);
+    REQUIRE(stats.peak_size == 4);
+    REQUIRE(stats.full_count == 1);
+
+    cb.pop_front();
+    cb.pop_back(2);
+    cb.push_back(9);
+    REQUIRE(cb.stats().pops == 3);
+    REQUIRE(cb.stats().full_count == 1);
+
+    const int values[] = { 1, 2, 3, 4, 5, 6 };
+    cb.push_back(std::begin(values), std::end(values));
+    stats = cb.stats();
+    REQUIRE(stats.pushes == 14);
+    REQUIRE(stats.overwrites_front == 6);
+    REQUIRE(stats.full_count == 2);
+
+    auto copy = cb;
+    REQUIRE(copy.stats().pushes == 14);
+
+    cb.clear();
+    REQUIRE(cb.stats().pops == 3);
+
+    cb.push_back(1);
+    cb.reset_stats();
+    stats = cb.stats();
+    REQUIRE(stats.pushes == 0);
+    REQUIRE(stats.pops == 0);
+    REQUIRE(stats.peak_size == 1);
+
+    jm::circular_buffer<int, 4, jm::counter_index, jm::basic_stats> counted;
+    counted.push_back(1);
+    counted.push_front(0);
+    counted.emplace_back(2);
+    REQUIRE(counted.stats().peak_size == 3);
+
+    jm::circular_buffer<std::string, 2, jm::modulo_index, jm::basic_stats> strings{ "a" };
+    strings.emplace_back("b");
+    strings.emplace_front("c");
+    REQUIRE(strings.stats().pushes == 3);
+    REQUIRE(strings.stats().overwrites_back == 1);
+    REQUIRE(strings.stats().full_count == 1);
+}
+
+namespace {
+
+    struct counted_construct {
+        static int constructed;
+
+        int value;
+
+        explicit counted_construct(int v) : value(v) { ++constructed; }
+    };
+
+    int counted_construct::constructed = 0;
+
+} // namespace
+
+TEST_CASE("try push rejects when full")
+{
+    jm::circular_buffer<int, 3, jm::branchless_index> cb;
+    REQUIRE(cb.try_push_back(1));
+    REQUIRE(cb.try_push_front(0));
+    const int two = 2;
+    REQUIRE(cb.try_push_back(two));
+    REQUIRE_FALSE(cb.try_push_back(3));
+    REQUIRE_FALSE(cb.try_push_front(two));
+    REQUIRE(cb.size() == 3);
+    REQUIRE(cb.front() == 0);
+    REQUIRE(cb.back() == 2);
+
+    cb.pop_front();
+    REQUIRE(cb.try_push_back(3));
+    REQUIRE(cb.front() == 1);
+    REQUIRE(cb.back() == 3);
+
+    jm::circular_buffer<counted_construct, 2, jm::counter_index, jm::basic_stats> counted;
+    REQUIRE(counted.try_emplace_back(1));
+    REQUIRE(counted.try_emplace_front(0));
+    REQUIRE_FALSE(counted.try_emplace_back(2));
+    REQUIRE_FALSE(counted.try_emplace_front(-1));
+    REQUIRE(counted_construct::constructed == 2);
+    REQUIRE(counted.front().value == 0);
+    REQUIRE(counted.back().value == 1);
+    REQUIRE(counted.stats().pushes == 2);
+    REQUIRE(counted.stats().overwrites_front == 0);
+
+    jm::circular_buffer<std::unique_ptr<int>, 1> owners;
+    std::unique_ptr<int> first(new int(1));
+    std::unique_ptr<int> second(new int(2));
+    REQUIRE(owners.try_push_back(std::move(first)));
+    REQUIRE_FALSE(owners.try_push_back(std::move(second)));
+    REQUIRE(second != nullptr);
+    REQUIRE(*owners.front() == 1);
+}
+
+TEST_CASE("reserve, commit, peek and consume")
+{
+    jm::circular_buffer<int, 8, jm::counter_index, jm::basic_stats> cb;
+    for(int i = 0; i < 6; ++i)
+        cb.push_back(i);
+    cb.pop_front(5);
+
+    auto slots = cb.reserve_back(10);
+    REQUIRE(slots.first.second + slots.second.second == 7);
+    REQUIRE(slots.first.second == 2);
+    REQUIRE(slots.second.first == cb.data());
+
+    int next = 6;
+    for(std::size_t i = 0; i < slots.first.second; ++i)
+        new(slots.first.first + i) int(next++);
+    new(slots.second.first) int(next++);
+    cb.commit_back(3);
+    REQUIRE(cb.size() == 4);
+    REQUIRE(cb.back() == 8);
+    REQUIRE(cb.stats().pushes == 9);
+    REQUIRE(cb.stats().peak_size == 6);
+
+    const auto& ccb   = cb;
+    auto        ready = ccb.peek_front(3);
+    REQUIRE(ready.first.second == 3);
+    REQUIRE(ready.second.second == 0);
+    REQUIRE(ready.first.first[0] == 5);
+
+    auto all = cb.peek_front(100);
+    REQUIRE(all.first.second == 3);
+    REQUIRE(all.second.second == 1);
+    REQUIRE(all.second.first[0] == 8);
+    all.first.first[0] = 50;
+    REQUIRE(cb.front() == 50);
+
+    cb.consume_front(3);
+    REQUIRE(cb.size() == 1);
+    REQUIRE(cb.front() == 8);
+    REQUIRE(cb.stats().pops == 8);
+
+    const int more[] = { 1, 2, 3, 4, 5, 6, 7 };
+    cb.push_back(std::begin(more), std::end(more));
+    REQUIRE(cb.full());
+    slots = cb.reserve_back(1);
+    REQUIRE(slots.first.second == 0);
+    REQUIRE(slots.second.second == 0);
+}
+
+namespace {
+
+    struct alignas(64) over_aligned {
+        int value;
+    };
+
+    template<class Buffer>
+    std::uintptr_t offset_of_data(const Buffer& cb)
+    {
+        return reinterpret_cast<std::uintptr_t>(cb.data()) -
+               reinterpret_cast<std::uintptr_t>(&cb);
+    }
+
+} // namespace
+
+TEST_CASE("cache aligned layout and over aligned elements")
+{
+    typedef jm::circular_buffer<char, 8>                                     packed;
+    typedef jm::circular_buffer<char,
+                                8,
+                                jm::modulo_index,
+                                jm::no_stats,
+                                jm::cache_aligned_layout>
+        aligned;
+
+    REQUIRE(alignof(aligned) == JM_CB_CACHE_LINE_SIZE);
+    REQUIRE(sizeof(aligned) % JM_CB_CACHE_LINE_SIZE == 0);
+    REQUIRE(sizeof(packed) < JM_CB_CACHE_LINE_SIZE);
+
+    aligned rings[2];
+    REQUIRE(offset_of_data(rings[0]) == JM_CB_CACHE_LINE_SIZE);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(rings[1].data()) % JM_CB_CACHE_LINE_SIZE == 0);
+    rings[1].push_back('a');
+    REQUIRE(rings[1].front() == 'a');
+
+    jm::circular_buffer<over_aligned, 4> wide;
+    for(int i = 0; i < 6; ++i)
+        wide.push_back(over_aligned{ i });
+    for(const auto& element : wide)
+        REQUIRE(reinterpret_cast<std::uintptr_t>(&element) % 64 == 0);
+    REQUIRE(wide.front().value == 2);
+}
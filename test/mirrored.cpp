@@ -0,0 +1,86 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <mirrored_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <unistd.h>
+
+TEST_CASE("mirrored circular buffer capacity is rounded to pages")
+{
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    jm::mirrored_circular_buffer<char> bytes(1);
+    REQUIRE(bytes.capacity() >= 1);
+    REQUIRE(bytes.capacity() % page == 0);
+    REQUIRE(bytes.empty());
+
+    struct three {
+        char c[3];
+    };
+    jm::mirrored_circular_buffer<three> odd(10);
+    REQUIRE(odd.capacity() >= 10);
+    REQUIRE(odd.capacity() * sizeof(three) % page == 0);
+}
+
+TEST_CASE("mirrored circular buffer views are contiguous across the wrap")
+{
+    jm::mirrored_circular_buffer<std::uint32_t> cb(1024);
+    const std::size_t                           cap = cb.capacity();
+
+    std::vector<std::uint32_t> src(cap);
+    std::iota(src.begin(), src.end(), 0u);
+
+    // move the head close to the end of the storage
+    REQUIRE(cb.write(src.data(), cap - 3) == cap - 3);
+    cb.consume(cap - 3);
+    REQUIRE(cb.empty());
+
+    // write through data_from_tail across the wrap point
+    std::uint32_t* out = cb.data_from_tail();
+    for(std::uint32_t i = 0; i < 10; ++i)
+        out[i] = 100 + i;
+    cb.commit(10);
+
+    const std::uint32_t* in = cb.data_from_head();
+    for(std::uint32_t i = 0; i < 10; ++i) {
+        REQUIRE(in[i] == 100 + i);
+        REQUIRE(cb[i] == 100 + i);
+    }
+    REQUIRE(cb.front() == 100);
+    REQUIRE(cb.back() == 109);
+
+    // the wrapped elements are the ones at the start of the first view
+    REQUIRE(in + 3 - cap == cb.data_from_tail() - 7);
+    REQUIRE(in[5] == *(in + 5 - cap));
+
+    REQUIRE(cb.write(src.data(), cap) == cap - 10);
+    REQUIRE(cb.full());
+
+    std::vector<std::uint32_t> dst(cap);
+    REQUIRE(cb.read(dst.data(), cap) == cap);
+    REQUIRE(dst[9] == 109);
+    REQUIRE(std::equal(dst.begin() + 10, dst.end(), src.begin()));
+    REQUIRE(cb.empty());
+}
+
+TEST_CASE("mirrored circular buffer move")
+{
+    jm::mirrored_circular_buffer<char> a(100);
+    a.write("abc", 3);
+
+    jm::mirrored_circular_buffer<char> b(std::move(a));
+    REQUIRE(a.capacity() == 0);
+    REQUIRE(b.size() == 3);
+    REQUIRE(b.front() == 'a');
+
+    jm::mirrored_circular_buffer<char> c(1);
+    c = std::move(b);
+    REQUIRE(c.back() == 'c');
+}
+
+#endif
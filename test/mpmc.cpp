@@ -0,0 +1,203 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <mpmc_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("mpmc single threaded")
+{
+    jm::mpmc_circular_buffer<int, 3> q;
+    REQUIRE(q.empty());
+    REQUIRE(q.max_size() == 3);
+
+    REQUIRE(q.try_push(1));
+    REQUIRE(q.try_emplace(2));
+    q.emplace(3);
+    REQUIRE(q.size() == 3);
+    REQUIRE_FALSE(q.try_push(4));
+
+    int v = 0;
+    for(int i = 1; i <= 3; ++i) {
+        REQUIRE(q.try_pop(v));
+        REQUIRE(v == i);
+    }
+    REQUIRE_FALSE(q.try_pop(v));
+
+    // wraps around several times
+    for(int i = 0; i < 10; ++i) {
+        REQUIRE(q.try_push(i));
+        REQUIRE(q.try_pop(v));
+        REQUIRE(v == i);
+    }
+
+    jm::mpmc_circular_buffer<std::string, 2> sq;
+    REQUIRE(sq.try_emplace(40, 's'));
+    REQUIRE(sq.try_push(std::string(50, 't')));
+    std::string s;
+    REQUIRE(sq.try_pop(s));
+    REQUIRE(s == std::string(40, 's'));
+    // the remaining string is released by the destructor
+}
+
+TEST_CASE("mpmc smallest queue")
+{
+    // mpmc_circular_buffer<T, 1> does not compile: with one slot the sequence a push
+    // leaves behind reads as free for the next push, which overwrote the unread element
+    jm::mpmc_circular_buffer<std::unique_ptr<int>, 2> q;
+
+    std::unique_ptr<int> out;
+    for(int i = 0; i < 8; ++i) {
+        REQUIRE(q.try_push(std::unique_ptr<int>(new int(2 * i))));
+        REQUIRE(q.try_push(std::unique_ptr<int>(new int(2 * i + 1))));
+
+        std::unique_ptr<int> rejected(new int(-1));
+        REQUIRE_FALSE(q.try_push(std::move(rejected)));
+        REQUIRE(rejected);
+
+        REQUIRE(q.try_pop(out));
+        REQUIRE(*out == 2 * i);
+        REQUIRE(q.try_pop(out));
+        REQUIRE(*out == 2 * i + 1);
+        REQUIRE_FALSE(q.try_pop(out));
+    }
+}
+
+namespace {
+
+    // counts live instances, throws from its constructor on a negative value and from
+    // move assignment while fail_assign is set
+    struct throwing {
+        static int  live;
+        static bool fail_assign;
+
+        int value;
+
+        throwing() : value(0) { ++live; }
+
+        throwing(int v) : value(v)
+        {
+            if(v < 0)
+                throw std::runtime_error("throwing(int)");
+            ++live;
+        }
+
+        throwing(const throwing& other) : value(other.value) { ++live; }
+
+        throwing& operator=(throwing&& other)
+        {
+            if(fail_assign)
+                throw std::runtime_error("throwing::operator=");
+            value = other.value;
+            return *this;
+        }
+
+        ~throwing() { --live; }
+    };
+
+    int  throwing::live        = 0;
+    bool throwing::fail_assign = false;
+
+} // namespace
+
+TEST_CASE("mpmc survives throwing element operations")
+{
+    {
+        jm::mpmc_circular_buffer<throwing, 2> q;
+        throwing                              out;
+
+        // several laps so that every slot gets poisoned and reused
+        for(int i = 0; i < 6; ++i) {
+            REQUIRE_THROWS_AS(q.try_emplace(-1), std::runtime_error);
+            REQUIRE(q.try_emplace(i));
+            REQUIRE(q.try_pop(out));
+            REQUIRE(out.value == i);
+            REQUIRE_FALSE(q.try_pop(out));
+            REQUIRE(throwing::live == 1);
+        }
+
+        REQUIRE(q.try_emplace(10));
+        throwing::fail_assign = true;
+        REQUIRE_THROWS_AS(q.try_pop(out), std::runtime_error);
+        throwing::fail_assign = false;
+        REQUIRE(throwing::live == 1);
+        REQUIRE_FALSE(q.try_pop(out));
+
+        for(int i = 0; i < 4; ++i) {
+            q.emplace(20 + i);
+            REQUIRE(q.try_pop(out));
+            REQUIRE(out.value == 20 + i);
+        }
+
+        // a poisoned slot left in the queue is not destroyed with it
+        REQUIRE_THROWS_AS(q.emplace(-1), std::runtime_error);
+        REQUIRE(q.try_emplace(30));
+        REQUIRE(throwing::live == 2);
+    }
+    REQUIRE(throwing::live == 0);
+}
+
+TEST_CASE("mpmc stress")
+{
+    constexpr int           producers = 4;
+    constexpr int           consumers = 4;
+    constexpr std::uint32_t per_producer = 100000;
+
+    typedef jm::mpmc_circular_buffer<std::uint64_t, 64> queue;
+    std::unique_ptr<queue> q(new queue());
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p)
+        threads.emplace_back([&q, p] {
+            for(std::uint32_t i = 0; i < per_producer; ++i) {
+                const std::uint64_t value = (std::uint64_t(p) << 32) | i;
+                if(i % 2)
+                    q->emplace(value);
+                else
+                    while(!q->try_push(value))
+                        std::this_thread::yield();
+            }
+        });
+
+    std::atomic<std::uint64_t>              popped(0);
+    std::vector<std::vector<std::uint32_t>> seen(consumers * producers);
+    for(int c = 0; c < consumers; ++c)
+        threads.emplace_back([&, c] {
+            std::uint64_t value;
+            while(popped.load() < producers * per_producer) {
+                if(q->try_pop(value)) {
+                    seen[c * producers + (value >> 32)].push_back(std::uint32_t(value));
+                    ++popped;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+
+    for(auto& t : threads)
+        t.join();
+
+    REQUIRE(q->empty());
+
+    // every value arrives exactly once and each consumer sees a producer's values in order
+    for(int p = 0; p < producers; ++p) {
+        std::vector<std::uint32_t> all;
+        for(int c = 0; c < consumers; ++c) {
+            const auto& s = seen[c * producers + p];
+            REQUIRE(std::is_sorted(s.begin(), s.end()));
+            all.insert(all.end(), s.begin(), s.end());
+        }
+
+        std::sort(all.begin(), all.end());
+        REQUIRE(all.size() == per_producer);
+
+        bool each_once = true;
+        for(std::uint32_t i = 0; i < per_producer; ++i)
+            each_once &= all[i] == i;
+        REQUIRE(each_once);
+    }
+}
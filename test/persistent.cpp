@@ -0,0 +1,192 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <persistent_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+
+namespace {
+
+    struct temp_file {
+        std::string path;
+
+        temp_file()
+        {
+            char name[] = "/tmp/jm_persistent_XXXXXX";
+            const int fd = ::mkstemp(name);
+            REQUIRE(fd != -1);
+            ::close(fd);
+            path = name;
+        }
+
+        ~temp_file() { std::remove(path.c_str()); }
+    };
+
+    struct record {
+        unsigned seq;
+        double   value;
+    };
+
+    // where the live popped counter and the first slot sit in the file
+    const long popped_offset = 56;
+    const long data_offset   = 64;
+
+    template<class T>
+    T read_at(const std::string& path, long offset)
+    {
+        T           value = T();
+        std::FILE*  f     = std::fopen(path.c_str(), "rb");
+        REQUIRE(f != nullptr);
+        std::fseek(f, offset, SEEK_SET);
+        REQUIRE(std::fread(&value, sizeof(T), 1, f) == 1);
+        std::fclose(f);
+        return value;
+    }
+
+    template<class T>
+    void write_at(const std::string& path, long offset, const T& value)
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        REQUIRE(f != nullptr);
+        std::fseek(f, offset, SEEK_SET);
+        REQUIRE(std::fwrite(&value, sizeof(T), 1, f) == 1);
+        std::fclose(f);
+    }
+
+    template<class Buffer>
+    std::vector<unsigned> sequence(const Buffer& cb)
+    {
+        std::vector<unsigned> seqs;
+        for(std::size_t i = 0; i < cb.size(); ++i)
+            seqs.push_back(cb[i].seq);
+        return seqs;
+    }
+
+} // namespace
+
+TEST_CASE("persistent circular buffer survives a reopen")
+{
+    temp_file file;
+    {
+        jm::persistent_circular_buffer<record> cb(file.path.c_str(), 4);
+        REQUIRE(cb.empty());
+        REQUIRE(cb.capacity() == 4);
+        for(unsigned i = 0; i < 6; ++i)
+            cb.push_back(record{ i, i * 0.5 });
+        cb.pop_front();
+        REQUIRE(sequence(cb) == (std::vector<unsigned>{ 3, 4, 5 }));
+    }
+
+    jm::persistent_circular_buffer<record> cb(file.path.c_str(), 4);
+    REQUIRE(sequence(cb) == (std::vector<unsigned>{ 3, 4, 5 }));
+    REQUIRE(cb.front().value == 1.5);
+    REQUIRE(cb.back().seq == 5);
+    REQUIRE(cb.array_one().second + cb.array_two().second == 3);
+
+    cb.push_back(record{ 6, 3.0 });
+    cb.push_back(record{ 7, 3.5 });
+    REQUIRE(cb.full());
+    REQUIRE(sequence(cb) == (std::vector<unsigned>{ 4, 5, 6, 7 }));
+    cb.clear();
+    REQUIRE(cb.empty());
+}
+
+TEST_CASE("persistent circular buffer recovers after a crash")
+{
+    temp_file file;
+
+    const pid_t pid = ::fork();
+    REQUIRE(pid != -1);
+    if(pid == 0) {
+        jm::persistent_circular_buffer<record> cb(file.path.c_str(), 8);
+        for(unsigned i = 0; i < 5; ++i)
+            cb.push_back(record{ i, 0.0 });
+        cb.flush();
+        for(unsigned i = 5; i < 11; ++i)
+            cb.push_back(record{ i, 0.0 });
+        cb.pop_front(2);
+        ::_exit(0); // no destructor, no flush
+    }
+
+    int status = 0;
+    REQUIRE(::waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+
+    SECTION("latest state")
+    {
+        jm::persistent_circular_buffer<record> cb(file.path.c_str(), 8);
+        REQUIRE(sequence(cb) == (std::vector<unsigned>{ 5, 6, 7, 8, 9, 10 }));
+    }
+
+    SECTION("last flush")
+    {
+        jm::persistent_circular_buffer<record> cb(
+            file.path.c_str(), 8, jm::persistent_recovery::flushed);
+        // pushes 8 to 10 overwrote 0 to 2 and a torn push 11 would have hit 3, only
+        // the newest checkpoint element is left
+        REQUIRE(sequence(cb) == (std::vector<unsigned>{ 4 }));
+
+        cb.push_back(record{ 5, 0.0 });
+        REQUIRE(sequence(cb) == (std::vector<unsigned>{ 4, 5 }));
+    }
+}
+
+TEST_CASE("persistent circular buffer recovers from a crash inside a push")
+{
+    temp_file file;
+    {
+        jm::persistent_circular_buffer<record> cb(file.path.c_str(), 4);
+        for(unsigned i = 0; i < 6; ++i)
+            cb.push_back(record{ i, 0.0 });
+    }
+
+    // pushes into the full ring retired the elements they overwrote
+    REQUIRE(read_at<std::uint64_t>(file.path, popped_offset) == 2);
+
+    // a crash inside the next push, after the slot of 2 was written and before the
+    // push was counted
+    write_at(file.path, popped_offset, std::uint64_t(3));
+    write_at(file.path, data_offset + 2 * sizeof(record), record{ 100, 0.0 });
+
+    jm::persistent_circular_buffer<record> cb(file.path.c_str(), 4);
+    REQUIRE(sequence(cb) == (std::vector<unsigned>{ 3, 4, 5 }));
+
+    cb.push_back(record{ 6, 0.0 });
+    cb.push_back(record{ 7, 0.0 });
+    REQUIRE(sequence(cb) == (std::vector<unsigned>{ 4, 5, 6, 7 }));
+}
+
+TEST_CASE("persistent circular buffer rejects mismatched or corrupt files")
+{
+    temp_file file;
+    {
+        jm::persistent_circular_buffer<record> cb(file.path.c_str(), 4);
+        cb.push_back(record{ 1, 1.0 });
+        cb.flush();
+    }
+
+    REQUIRE_THROWS_AS(jm::persistent_circular_buffer<record>(file.path.c_str(), 8),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(jm::persistent_circular_buffer<record>(file.path.c_str(), 0),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(jm::persistent_circular_buffer<int>("/nonexistent/dir/ring", 4),
+                      std::system_error);
+
+    {
+        std::FILE* f = std::fopen(file.path.c_str(), "r+b");
+        REQUIRE(f != nullptr);
+        std::fseek(f, 32, SEEK_SET); // flushed_pushed, caught by the checksum
+        std::fputc(0xff, f);
+        std::fclose(f);
+    }
+    REQUIRE_THROWS_AS(jm::persistent_circular_buffer<record>(file.path.c_str(), 4),
+                      std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,114 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <rolling_stats.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <random>
+
+template<class Stats, class Model>
+static void require_stats(const Stats& stats, const Model& model)
+{
+    REQUIRE(stats.count() == model.size());
+
+    double sum = 0;
+    for(auto v : model)
+        sum += v;
+    const double mean = model.empty() ? 0 : sum / model.size();
+
+    double m2 = 0;
+    for(auto v : model)
+        m2 += (v - mean) * (v - mean);
+
+    const double scale = 1 + std::abs(sum);
+    REQUIRE(std::abs(stats.sum() - sum) <= 1e-9 * scale);
+    REQUIRE(std::abs(stats.mean() - mean) <= 1e-9 * (1 + std::abs(mean)));
+    if(!model.empty())
+        REQUIRE(std::abs(stats.variance() - m2 / model.size()) <= 1e-7 * (1 + m2));
+    if(model.size() > 1)
+        REQUIRE(std::abs(stats.sample_variance() - m2 / (model.size() - 1)) <= 1e-7 * (1 + m2));
+}
+
+TEST_CASE("rolling stats match a recomputed window")
+{
+    std::mt19937                           gen(42);
+    std::uniform_real_distribution<double> dist(-100, 100);
+
+    jm::rolling_stats<double, 64> stats;
+    std::deque<double>            model;
+    REQUIRE(stats.empty());
+    REQUIRE(stats.variance() == 0);
+
+    for(int i = 0; i < 2000; ++i) {
+        const double v = dist(gen);
+        stats.push(v);
+        model.push_back(v);
+        if(model.size() > 64)
+            model.pop_front();
+
+        if(i % 7 == 0) {
+            stats.pop();
+            model.pop_front();
+        }
+
+        require_stats(stats, model);
+    }
+
+    stats.recompute();
+    require_stats(stats, model);
+
+    while(!stats.empty()) {
+        stats.pop();
+        model.pop_front();
+        require_stats(stats, model);
+    }
+}
+
+TEST_CASE("rolling stats drift and recompute")
+{
+    // a large offset makes the naive running sum lose most of its precision
+    jm::rolling_stats<double, 100, jm::branchless_index> stats;
+    std::deque<double>                                   model;
+    for(int i = 0; i < 100000; ++i) {
+        const double v = 1e9 + (i % 13) * 0.1;
+        stats.push(v);
+        model.push_back(v);
+        if(model.size() > 100)
+            model.pop_front();
+    }
+
+    // the variance of values this far from zero drifts a little, recompute removes it
+    double mean = 0;
+    for(double v : model)
+        mean += (v - 1e9) / model.size();
+    double variance = 0;
+    for(double v : model)
+        variance += (v - 1e9 - mean) * (v - 1e9 - mean) / model.size();
+
+    REQUIRE(stats.mean() - 1e9 == Approx(mean).epsilon(1e-6));
+    REQUIRE(stats.variance() == Approx(variance).epsilon(1e-3));
+
+    stats.recompute();
+    require_stats(stats, model);
+    REQUIRE(stats.full());
+
+    stats.clear();
+    REQUIRE(stats.count() == 0);
+    REQUIRE(stats.sum() == 0);
+}
+
+TEST_CASE("rolling stats of integers")
+{
+    jm::rolling_stats<std::int32_t, 3> stats;
+    stats.push(1);
+    stats.push(2);
+    stats.push(3);
+    stats.push(4);
+
+    REQUIRE(stats.sum() == Approx(9.0));
+    REQUIRE(stats.mean() == Approx(3.0));
+    REQUIRE(stats.variance() == Approx(2.0 / 3.0));
+    REQUIRE(stats.sample_variance() == Approx(1.0));
+    REQUIRE(stats.window().front() == 2);
+}
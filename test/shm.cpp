@@ -0,0 +1,131 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <shm_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/wait.h>
+
+namespace {
+
+    // an anonymous POSIX shared memory object, unlinked right away so that only the
+    // fd and the processes it is inherited by can reach it
+    struct shm_object {
+        int fd;
+
+        shm_object()
+        {
+            const std::string name = "/jm_shm_test_" + std::to_string(::getpid());
+            fd                     = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            REQUIRE(fd != -1);
+            ::shm_unlink(name.c_str());
+        }
+
+        ~shm_object() { ::close(fd); }
+    };
+
+    struct message {
+        std::uint64_t seq;
+        std::uint64_t check;
+    };
+
+} // namespace
+
+TEST_CASE("shm spsc single process")
+{
+    shm_object shm;
+    auto       producer = jm::shm_spsc_circular_buffer<int>::create(shm.fd, 4);
+    auto       consumer = jm::shm_spsc_circular_buffer<int>::attach(shm.fd);
+    REQUIRE(consumer.capacity() == 4);
+    REQUIRE(consumer.empty());
+
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(producer.try_push(i));
+    REQUIRE_FALSE(producer.try_push(4));
+    REQUIRE(consumer.full());
+
+    int v = -1;
+    REQUIRE(consumer.try_pop(v));
+    REQUIRE(v == 0);
+
+    const int in[] = { 10, 11, 12 };
+    REQUIRE(producer.try_push(in, in + 3) == 1);
+
+    int out[8] = {};
+    REQUIRE(consumer.try_pop(out, 8) == 4);
+    REQUIRE(out[0] == 1);
+    REQUIRE(out[3] == 10);
+    REQUIRE_FALSE(consumer.try_pop(v));
+
+    // the bulk copy wraps around the end of the region
+    REQUIRE(producer.try_push(in, in + 3) == 3);
+    REQUIRE(consumer.try_pop(out, 8) == 3);
+    REQUIRE(out[2] == 12);
+}
+
+TEST_CASE("shm spsc attach validates the region")
+{
+    shm_object shm;
+    REQUIRE_THROWS_AS(jm::shm_spsc_circular_buffer<int>::attach(shm.fd), std::runtime_error);
+    REQUIRE_THROWS_AS(jm::shm_spsc_circular_buffer<int>::create(shm.fd, 0),
+                      std::invalid_argument);
+
+    auto cb = jm::shm_spsc_circular_buffer<message>::create(shm.fd, 16);
+    REQUIRE(jm::shm_spsc_circular_buffer<message>::attach(shm.fd).capacity() == 16);
+    REQUIRE_THROWS_AS(jm::shm_spsc_circular_buffer<int>::attach(shm.fd), std::runtime_error);
+    REQUIRE_THROWS_AS(jm::shm_spsc_circular_buffer<message>::attach(-1), std::system_error);
+}
+
+TEST_CASE("shm spsc between two processes")
+{
+    const std::uint64_t count = 200000;
+
+    shm_object shm;
+    auto       consumer = jm::shm_spsc_circular_buffer<message>::create(shm.fd, 64);
+
+    const pid_t pid = ::fork();
+    REQUIRE(pid != -1);
+    if(pid == 0) {
+        // a mapping of its own, at whatever address the child gets
+        auto producer = jm::shm_spsc_circular_buffer<message>::attach(shm.fd);
+        message batch[7];
+        for(std::uint64_t seq = 0; seq < count;) {
+            const std::uint64_t n = (std::min<std::uint64_t>)(7, count - seq);
+            for(std::uint64_t i = 0; i < n; ++i)
+                batch[i] = message{ seq + i, (seq + i) * 31 };
+
+            const std::size_t pushed = producer.try_push(batch, batch + n);
+            if(pushed == 0)
+                ::sched_yield();
+            seq += pushed;
+        }
+        ::_exit(0);
+    }
+
+    std::uint64_t expected = 0;
+    bool          in_order = true;
+    while(expected < count) {
+        message m;
+        if(!consumer.try_pop(m)) {
+            ::sched_yield();
+            continue;
+        }
+
+        in_order = in_order && m.seq == expected && m.check == expected * 31;
+        ++expected;
+    }
+
+    int status = 0;
+    REQUIRE(::waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE(in_order);
+    REQUIRE(consumer.empty());
+}
+
+#endif
@@ -0,0 +1,90 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <sliding_min_max.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+
+TEST_CASE("sliding min max over the last N pushes")
+{
+    std::mt19937                       gen(7);
+    std::uniform_int_distribution<int> dist(-50, 50);
+
+    jm::sliding_min_max<int, 16> window;
+    std::deque<int>              model;
+    REQUIRE(window.empty());
+
+    for(int i = 0; i < 3000; ++i) {
+        // long monotonic runs fill the deques up to their capacity
+        const int v = i % 500 < 100 ? i : i % 500 < 200 ? -i : dist(gen);
+        window.push(v);
+        model.push_back(v);
+        if(model.size() > 16)
+            model.pop_front();
+
+        REQUIRE(window.min() == *std::min_element(model.begin(), model.end()));
+        REQUIRE(window.max() == *std::max_element(model.begin(), model.end()));
+    }
+
+    window.clear();
+    REQUIRE(window.empty());
+    window.push(3);
+    REQUIRE(window.min() == 3);
+    REQUIRE(window.max() == 3);
+}
+
+TEST_CASE("sliding min max with timestamps")
+{
+    jm::sliding_min_max<double, 64, std::less<double>, long> window;
+
+    struct sample {
+        long   time;
+        double value;
+    };
+    std::deque<sample> model;
+
+    std::mt19937                           gen(11);
+    std::uniform_real_distribution<double> dist(0, 1);
+    long                                   now = 0;
+    for(int i = 0; i < 2000; ++i) {
+        now += 1 + static_cast<long>(dist(gen) * 5);
+        const double v = dist(gen);
+        window.push(v, now);
+        model.push_back({ now, v });
+
+        // keep the last 50 time units
+        window.expire_before(now - 50);
+        while(model.front().time < now - 50)
+            model.pop_front();
+
+        double lo = model.front().value, hi = lo;
+        for(const sample& s : model) {
+            lo = (std::min)(lo, s.value);
+            hi = (std::max)(hi, s.value);
+        }
+
+        REQUIRE(window.min() == lo);
+        REQUIRE(window.max() == hi);
+        REQUIRE(window.min_key() >= now - 50);
+    }
+
+    window.expire_before(now + 1);
+    REQUIRE(window.empty());
+}
+
+TEST_CASE("sliding min max with a custom comparator")
+{
+    jm::sliding_min_max<std::string, 3, std::greater<std::string>> window;
+    window.push("b");
+    window.push("c");
+    window.push("a");
+    REQUIRE(window.min() == "c");
+    REQUIRE(window.max() == "a");
+
+    window.push("a");
+    window.push("a");
+    REQUIRE(window.min() == "a");
+    REQUIRE(window.max() == "a");
+}
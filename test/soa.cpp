@@ -0,0 +1,214 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <soa_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    typedef jm::soa_circular_buffer<4, double, int, std::string> ticks;
+
+    template<class Range>
+    double column_sum(const Range& one, const Range& two)
+    {
+        return std::accumulate(one.first, one.first + one.second, 0.0) +
+               std::accumulate(two.first, two.first + two.second, 0.0);
+    }
+
+    // counts the live instances, a leaked field shows up as a count that stays up
+    struct counted {
+        static int live;
+
+        counted() { ++live; }
+
+        counted(const counted&) { ++live; }
+
+        counted& operator=(const counted&) { return *this; }
+
+        ~counted() { --live; }
+    };
+
+    int counted::live = 0;
+
+    // throws on a negative value and, while fail_copies is set, on every copy
+    struct throwing {
+        static bool fail_copies;
+
+        int value;
+
+        throwing(int v) : value(v)
+        {
+            if(v < 0)
+                throw std::runtime_error("throwing(int)");
+        }
+
+        throwing(const throwing& other) : value(other.value)
+        {
+            if(fail_copies)
+                throw std::runtime_error("throwing(const throwing&)");
+        }
+
+        throwing& operator=(const throwing&) = default;
+    };
+
+    bool throwing::fail_copies = false;
+
+} // namespace
+
+TEST_CASE("soa circular buffer pushes rows and overwrites the oldest")
+{
+    ticks cb;
+    REQUIRE(cb.empty());
+    REQUIRE(cb.max_size() == 4);
+
+    for(int i = 0; i < 6; ++i)
+        cb.emplace_back(i * 1.5, i, std::to_string(i));
+
+    REQUIRE(cb.full());
+    REQUIRE(std::get<1>(cb.front()) == 2);
+    REQUIRE(std::get<2>(cb.back()) == "5");
+    REQUIRE(cb.get<0>(1) == 4.5);
+    REQUIRE(cb.get<2>(3) == "5");
+
+    const ticks::value_type row(10.0, 10, "ten");
+    cb.push_back(row);
+    cb.push_back(ticks::value_type(11.0, 11, "eleven"));
+    REQUIRE(std::get<1>(cb.front()) == 4);
+    REQUIRE(std::get<2>(cb[3]) == "eleven");
+
+    std::get<1>(cb[0]) = 40;
+    REQUIRE(cb.get<1>(0) == 40);
+
+    cb.pop_front();
+    cb.pop_back();
+    REQUIRE(cb.size() == 2);
+    REQUIRE(std::get<2>(cb.front()) == "5");
+    REQUIRE(std::get<2>(cb.back()) == "ten");
+    REQUIRE_THROWS_AS(cb.at(2), std::out_of_range);
+
+    cb.clear();
+    REQUIRE(cb.empty());
+    cb.emplace_back(1.0, 1, "one");
+    REQUIRE(std::get<2>(cb.front()) == "one");
+}
+
+TEST_CASE("soa circular buffer columns are two contiguous runs")
+{
+    jm::soa_circular_buffer<8, float, unsigned> cb;
+    for(unsigned i = 0; i < 13; ++i)
+        cb.emplace_back(static_cast<float>(i), i * 2);
+
+    const auto& ccb = cb;
+    auto        one = ccb.array_one<0>();
+    auto        two = ccb.array_two<0>();
+    REQUIRE(one.second + two.second == 8);
+    REQUIRE(two.second == 5);
+    REQUIRE(one.first == ccb.data<0>() + 5);
+    REQUIRE(column_sum(one, two) == 5 + 6 + 7 + 8 + 9 + 10 + 11 + 12);
+
+    auto ints = cb.array_one<1>();
+    for(std::size_t i = 0; i < ints.second; ++i)
+        ints.first[i] = 0;
+    REQUIRE(cb.get<1>(0) == 0);
+    REQUIRE(cb.get<1>(3) == 16);
+}
+
+TEST_CASE("soa circular buffer proxy iterators")
+{
+    ticks cb;
+    for(int i = 0; i < 5; ++i)
+        cb.emplace_back(i * 1.0, i, std::string(static_cast<std::size_t>(i), 'x'));
+
+    REQUIRE(cb.end() - cb.begin() == 4);
+    REQUIRE(std::distance(cb.rbegin(), cb.rend()) == 4);
+
+    std::vector<int> ints;
+    for(auto row : cb)
+        ints.push_back(std::get<1>(row));
+    REQUIRE(ints == std::vector<int>{ 1, 2, 3, 4 });
+
+    for(auto row : cb)
+        std::get<0>(row) *= 2;
+    REQUIRE(cb.get<0>(3) == 8.0);
+
+    ticks::const_iterator it = cb.begin();
+    it += 2;
+    REQUIRE(std::get<2>(*it) == "xxx");
+    REQUIRE(std::get<1>(it[1]) == 4);
+    REQUIRE(std::get<1>(*(cb.rbegin())) == 4);
+    REQUIRE(it > cb.cbegin());
+    REQUIRE(std::get<1>(*std::find_if(cb.begin(), cb.end(), [](ticks::const_reference r) {
+                return std::get<2>(r).size() == 2;
+            })) == 2);
+}
+
+TEST_CASE("soa circular buffer copy and move")
+{
+    ticks cb;
+    for(int i = 0; i < 6; ++i)
+        cb.emplace_back(i * 1.0, i, std::to_string(i));
+
+    ticks copy(cb);
+    REQUIRE(copy.size() == 4);
+    REQUIRE(copy.array_one<1>().second == 4);
+    REQUIRE(std::equal(cb.begin(), cb.end(), copy.begin()));
+
+    ticks moved(std::move(copy));
+    REQUIRE(std::get<2>(moved.back()) == "5");
+
+    ticks assigned;
+    assigned.emplace_back(0.0, 0, "zero");
+    assigned = moved;
+    REQUIRE(assigned.size() == 4);
+    REQUIRE(std::get<2>(assigned.front()) == "2");
+
+    assigned = std::move(moved);
+    REQUIRE(std::get<2>(assigned.back()) == "5");
+}
+
+TEST_CASE("soa circular buffer does not leak fields when a constructor throws")
+{
+    typedef jm::soa_circular_buffer<3, counted, throwing> rows;
+    {
+        rows cb;
+        cb.emplace_back(counted(), 1);
+        REQUIRE_THROWS_AS(cb.emplace_back(counted(), -1), std::runtime_error);
+        REQUIRE(cb.size() == 1);
+        REQUIRE(counted::live == 1);
+
+        const rows::value_type bad(counted(), 2);
+        throwing::fail_copies = true;
+        REQUIRE_THROWS_AS(cb.push_back(bad), std::runtime_error);
+        throwing::fail_copies = false;
+        REQUIRE(cb.size() == 1);
+        REQUIRE(counted::live == 2);
+
+        cb.emplace_back(counted(), 2);
+        cb.emplace_back(counted(), 3);
+        REQUIRE(cb.full());
+
+        // a full buffer drops its oldest row before the new one fails
+        REQUIRE_THROWS_AS(cb.emplace_back(counted(), -1), std::runtime_error);
+        REQUIRE(cb.size() == 2);
+        REQUIRE(cb.get<1>(0).value == 2);
+        REQUIRE(cb.get<1>(1).value == 3);
+        REQUIRE(counted::live == 3);
+
+        cb.emplace_back(counted(), 4);
+        REQUIRE(cb.full());
+        REQUIRE(cb.get<1>(2).value == 4);
+
+        throwing::fail_copies = true;
+        REQUIRE_THROWS_AS(rows(cb), std::runtime_error);
+        throwing::fail_copies = false;
+        REQUIRE(counted::live == 4);
+
+        rows copy(cb);
+        REQUIRE(copy.get<1>(0).value == 2);
+        REQUIRE(counted::live == 7);
+    }
+    REQUIRE(counted::live == 0);
+}
@@ -0,0 +1,110 @@
+#define JM_CIRCULAR_BUFFER_CXX14
+#include <spsc_circular_buffer.hpp>
+#include "../Catch/include/catch.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("spsc single threaded")
+{
+    jm::spsc_circular_buffer<int, 4> q;
+    REQUIRE(q.empty());
+    REQUIRE(q.max_size() == 4);
+
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(q.try_push(i));
+    REQUIRE(q.full());
+    REQUIRE_FALSE(q.try_push(4));
+    REQUIRE_FALSE(q.try_emplace(4));
+
+    int v = -1;
+    REQUIRE(q.try_pop(v));
+    REQUIRE(v == 0);
+    REQUIRE(q.try_emplace(4));
+
+    int out[8] = {};
+    REQUIRE(q.try_pop(out, 8) == 4);
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(out[i] == i + 1);
+    REQUIRE_FALSE(q.try_pop(v));
+
+    const int in[] = { 10, 11, 12, 13, 14, 15 };
+    REQUIRE(q.try_push(in, in + 6) == 4);
+    REQUIRE(q.try_pop(out, 2) == 2);
+    REQUIRE(q.try_push(in + 4, in + 6) == 2);
+    REQUIRE(q.try_pop(out, 8) == 4);
+    REQUIRE(out[0] == 12);
+    REQUIRE(out[3] == 15);
+}
+
+TEST_CASE("spsc non trivial types")
+{
+    const std::string long_string(64, 'x');
+    {
+        jm::spsc_circular_buffer<std::string, 3> q;
+        REQUIRE(q.try_push(long_string));
+        REQUIRE(q.try_emplace(3, 'y'));
+
+        std::vector<std::string> src(2, long_string);
+        REQUIRE(q.try_push(src.begin(), src.end()) == 1);
+
+        std::string s;
+        REQUIRE(q.try_pop(s));
+        REQUIRE(s == long_string);
+
+        std::vector<std::string> out;
+        REQUIRE(q.try_pop(std::back_inserter(out), 1) == 1);
+        REQUIRE(out[0] == "yyy");
+        // one element is left for the destructor
+    }
+}
+
+TEST_CASE("spsc stress")
+{
+    constexpr std::uint64_t count = 1000000;
+
+    auto q = std::unique_ptr<jm::spsc_circular_buffer<std::uint64_t, 1000>>(
+        new jm::spsc_circular_buffer<std::uint64_t, 1000>());
+
+    std::thread producer([&] {
+        std::uint64_t batch[7];
+        std::uint64_t next = 0;
+        while(next < count) {
+            if(next % 3 == 0) {
+                if(q->try_push(next))
+                    ++next;
+                else
+                    std::this_thread::yield();
+            }
+            else {
+                const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(7, count - next));
+                for(std::size_t i = 0; i < n; ++i)
+                    batch[i] = next + i;
+                next += q->try_push(batch, batch + n);
+            }
+        }
+    });
+
+    std::uint64_t expected = 0;
+    bool          in_order = true;
+    while(expected < count) {
+        std::uint64_t values[5];
+        const auto    n = q->try_pop(values, 5);
+        for(std::size_t i = 0; i < n; ++i)
+            in_order &= values[i] == expected++;
+
+        std::uint64_t value;
+        if(q->try_pop(value))
+            in_order &= value == expected++;
+        else
+            std::this_thread::yield();
+    }
+
+    producer.join();
+    REQUIRE(in_order);
+    REQUIRE(expected == count);
+    REQUIRE(q->empty());
+}